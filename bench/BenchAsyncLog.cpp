@@ -0,0 +1,84 @@
+#include "benchmark/benchmark.h"
+#include "carj/AsyncLog.h"
+
+#include <iostream>
+#include <streambuf>
+
+namespace {
+	/**
+	 * Discards everything, so only the cost of the logging thread is
+	 * measured and not the one of the terminal.
+	 */
+	class NullBuffer: public std::streambuf {
+	protected:
+		int overflow(int c) {
+			return c;
+		}
+
+		std::streamsize xsputn(const char*, std::streamsize n) {
+			return n;
+		}
+	};
+
+	/**
+	 * Enables the default logger and sends std::cout to a NullBuffer for
+	 * the lifetime of the scope, BenchMain disables all loggers.
+	 */
+	class DiscardedLogging {
+	public:
+		DiscardedLogging():
+			previous(std::cout.rdbuf(&discard))
+		{
+			el::Loggers::reconfigureLogger("default",
+				el::ConfigurationType::Enabled, "true");
+		}
+
+		~DiscardedLogging() {
+			el::Loggers::reconfigureLogger("default",
+				el::ConfigurationType::Enabled, "false");
+			std::cout.rdbuf(previous);
+		}
+
+	private:
+		NullBuffer discard;
+		std::streambuf* previous;
+	};
+}
+
+static void LogSynchronous(benchmark::State& state) {
+	DiscardedLogging logging;
+	for (auto _: state) {
+		LOG(INFO) << "makespan: " << state.iterations();
+	}
+}
+BENCHMARK(LogSynchronous);
+
+/**
+ * Cost of a LOG statement in the logging thread, the consumer formats and
+ * writes in the background.
+ */
+static void LogAsynchronous(benchmark::State& state) {
+	DiscardedLogging logging;
+	carj::startAsyncLogging();
+	for (auto _: state) {
+		LOG(INFO) << "makespan: " << state.iterations();
+	}
+	carj::stopAsyncLogging();
+}
+BENCHMARK(LogAsynchronous);
+
+/**
+ * The copy into the buffer alone, which is the lower bound for the
+ * asynchronous dispatch.
+ */
+static void LogRingBufferPush(benchmark::State& state) {
+	carj::LogRingBuffer buffer(1 << 12);
+	carj::LogRingBuffer::Entry entry;
+	const std::string file = "src/PHPEncoder.h";
+	const std::string message = "makespan: 12";
+	for (auto _: state) {
+		buffer.tryPush(el::Level::Info, file, 59, message);
+		buffer.tryPop(entry);
+	}
+}
+BENCHMARK(LogRingBufferPush);
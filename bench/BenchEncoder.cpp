@@ -0,0 +1,88 @@
+#include "benchmark/benchmark.h"
+#include "CountingSolver.h"
+#include "ClauseFingerprint.h"
+#include "PHPEncoder.h"
+
+#include <memory>
+
+static void SatVariableLookup(benchmark::State& state) {
+	unsigned n = state.range(0);
+	SatVariableAllocator allocator;
+	auto P = allocator.newVariable(n, n - 1);
+
+	while (state.KeepRunning()) {
+		for (unsigned pigeon = 0; pigeon < n; pigeon++) {
+			for (unsigned hole = 0; hole < n - 1; hole++) {
+				benchmark::DoNotOptimize(P(pigeon, hole));
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * n * (n - 1));
+}
+BENCHMARK(SatVariableLookup)->Arg(10)->Arg(50)->Arg(100);
+
+static void AddAtMostOnePigeonInHole(benchmark::State& state) {
+	unsigned n = state.range(0);
+	UniversalPHPEncoder encoder(std::make_unique<ipasir::Solver>(), n);
+
+	while (state.KeepRunning()) {
+		for (unsigned hole = 0; hole < n - 1; hole++) {
+			encoder.addAtMostOnePigeonInHole(hole);
+		}
+	}
+
+	// items are clauses
+	state.SetItemsProcessed(
+		state.iterations() * (n - 1) * n * (n - 1) / 2);
+}
+BENCHMARK(AddAtMostOnePigeonInHole)->Arg(10)->Arg(20)->Arg(40);
+
+static void AddAtMostOnePigeonInHoleFingerprint(benchmark::State& state) {
+	unsigned n = state.range(0);
+	UniversalPHPEncoder encoder(
+		std::make_unique<FingerprintDecorator>(
+			std::make_unique<CountingSolver>()),
+		n);
+
+	while (state.KeepRunning()) {
+		for (unsigned hole = 0; hole < n - 1; hole++) {
+			encoder.addAtMostOnePigeonInHole(hole);
+		}
+	}
+
+	// items are clauses
+	state.SetItemsProcessed(
+		state.iterations() * (n - 1) * n * (n - 1) / 2);
+}
+BENCHMARK(AddAtMostOnePigeonInHoleFingerprint)->Arg(10)->Arg(20)->Arg(40);
+
+static void AddExtendedResolutionClauses(benchmark::State& state) {
+	unsigned n = state.range(0);
+	ExtendedPHPEncoder3SAT encoder(std::make_unique<ipasir::Solver>(), n);
+
+	while (state.KeepRunning()) {
+		encoder.addExtendedResolutionClauses();
+	}
+
+	// items are clauses
+	unsigned numClauses = 0;
+	for (unsigned layer = n; layer > 2; layer--) {
+		numClauses += 4 * (layer - 1) * (layer - 2);
+	}
+	state.SetItemsProcessed(state.iterations() * numClauses);
+}
+BENCHMARK(AddExtendedResolutionClauses)->Arg(10)->Arg(20)->Arg(40);
+
+static void EncodeExtendedParallel(benchmark::State& state) {
+	unsigned n = state.range(0);
+	unsigned numThreads = state.range(1);
+
+	while (state.KeepRunning()) {
+		ExtendedPHPEncoder3SAT encoder(std::make_unique<ipasir::Solver>(), n);
+		encoder.setEncodeThreads(numThreads);
+		encoder.encode();
+	}
+}
+BENCHMARK(EncodeExtendedParallel)
+	->Args({40, 1})->Args({40, 2})->Args({40, 4})->Args({40, 0})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,25 @@
+#include "benchmark/benchmark.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+int main(int argc, char** argv) {
+	// decorators report their statistics on destruction, which would
+	// clutter the benchmark output
+	el::Configurations conf;
+	conf.setToDefault();
+	conf.setGlobally(el::ConfigurationType::Enabled, "false");
+	el::Loggers::reconfigureAllLoggers(conf);
+
+	// the encoders read their options from the parameters, all of them
+	// keep their defaults
+	carj::getCarj().init(carj::Carj::configPath, false,
+		"/incphp/parameters");
+	*carj::getCarj().parameter = nlohmann::json::object();
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -0,0 +1,192 @@
+#include "benchmark/benchmark.h"
+#include "DecisionOrder.h"
+#include "LearnedClauseEvaluationDecorator.h"
+#include "StaticSolverStack.h"
+
+#include "ipasir/randomized_ipasir.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+	/**
+	 * Adds the direct encoding of the pigeon hole principle and returns the
+	 * number of added literals.
+	 */
+	unsigned addPHP(ipasir::Ipasir& solver, unsigned n) {
+		unsigned numLiterals = 0;
+		auto var = [n](unsigned pigeon, unsigned hole) {
+			return static_cast<int>(pigeon * (n - 1) + hole + 1);
+		};
+
+		for (unsigned pigeon = 0; pigeon < n; pigeon++) {
+			for (unsigned hole = 0; hole < n - 1; hole++) {
+				solver.add(var(pigeon, hole));
+				numLiterals++;
+			}
+			solver.add(0);
+		}
+
+		for (unsigned hole = 0; hole < n - 1; hole++) {
+			for (unsigned a = 1; a < n; a++) {
+				for (unsigned b = 0; b < a; b++) {
+					solver.addClause({-var(a, hole), -var(b, hole)});
+					numLiterals += 2;
+				}
+			}
+		}
+		return numLiterals;
+	}
+
+	std::vector<int> learnedClause(unsigned length) {
+		std::vector<int> clause;
+		for (unsigned i = 1; i <= length; i++) {
+			clause.push_back(-static_cast<int>(i));
+		}
+		clause.push_back(0);
+		return clause;
+	}
+}
+
+static void RandomizedSolverAdd(benchmark::State& state) {
+	unsigned n = state.range(0);
+	ipasir::RandomizedSolver solver(0, std::make_unique<ipasir::Solver>());
+
+	unsigned numLiterals = 0;
+	while (state.KeepRunning()) {
+		numLiterals = addPHP(solver, n);
+
+		state.PauseTiming();
+		solver.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * numLiterals);
+}
+BENCHMARK(RandomizedSolverAdd)->Arg(10)->Arg(20)->Arg(40);
+
+static void RandomizedSolverSolve(benchmark::State& state) {
+	unsigned n = state.range(0);
+	ipasir::RandomizedSolver solver(0, std::make_unique<ipasir::Solver>());
+
+	unsigned numLiterals = 0;
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		solver.reset();
+		numLiterals = addPHP(solver, n);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(solver.solve());
+	}
+	state.SetItemsProcessed(state.iterations() * numLiterals);
+}
+BENCHMARK(RandomizedSolverSolve)->Arg(10)->Arg(20)->Arg(40);
+
+/**
+ * Learned clauses exported by the solver, through the ring buffer of the
+ * solver and the randomized layer. The second argument selects whether they
+ * are consumed on a separate thread.
+ */
+static void SolverLearnedClauseExport(benchmark::State& state) {
+	unsigned length = state.range(0);
+	std::unique_ptr<ipasir::Solver> backend =
+		std::make_unique<ipasir::Solver>(state.range(1) != 0);
+	ipasir::Solver* exporting = backend.get();
+	ipasir::RandomizedSolver solver(0, std::move(backend));
+
+	std::vector<int> clause = learnedClause(length);
+	solver.addClause(std::vector<int>(clause.begin(), clause.end() - 1));
+	solver.solve();
+	solver.set_learn(length, [](int* learned){
+		benchmark::DoNotOptimize(learned);
+	});
+
+	while (state.KeepRunning()) {
+		ipasir::ipasir_learn_callback(exporting, clause.data());
+	}
+	solver.solve();
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SolverLearnedClauseExport)->Args({3, 0})->Args({10, 0})
+	->Args({100, 0})->Args({10, 1});
+
+/**
+ * Cost of asking for a decision literal, through the randomized layer into
+ * a fixed decision order.
+ */
+static void SelectLiteralCallback(benchmark::State& state) {
+	unsigned n = state.range(0);
+	std::unique_ptr<ipasir::Solver> backend = std::make_unique<ipasir::Solver>();
+	ipasir::Solver* selecting = backend.get();
+	ipasir::RandomizedSolver solver(0, std::move(backend));
+	addPHP(solver, n);
+	solver.solve();
+
+	std::vector<int> order;
+	for (unsigned i = 1; i <= n * (n - 1); i++) {
+		order.push_back(i);
+	}
+	DecisionOrder decisions(order);
+	solver.set_select_literal([&decisions]() {
+		return decisions.select();
+	});
+
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(
+			ipasir::ipasir_select_literal_callback(selecting));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SelectLiteralCallback)->Arg(10)->Arg(40);
+
+static void LearnedClauseEvaluationCallback(benchmark::State& state) {
+	unsigned length = state.range(0);
+	std::unique_ptr<ipasir::Solver> backend = std::make_unique<ipasir::Solver>();
+	ipasir::Solver* exporting = backend.get();
+	std::unique_ptr<ipasir::RandomizedSolver> randomized =
+		std::make_unique<ipasir::RandomizedSolver>(0, std::move(backend));
+
+	std::vector<int> clause = learnedClause(length);
+	randomized->addClause(std::vector<int>(clause.begin(), clause.end() - 1));
+	randomized->solve();
+
+	LearnedClauseEvaluationDecorator decorator(std::move(randomized));
+	decorator.set_learn(length, [](int* learned){
+		benchmark::DoNotOptimize(learned);
+	});
+	for (unsigned i = 1; i <= length; i += 2) {
+		decorator.assume(i);
+	}
+
+	while (state.KeepRunning()) {
+		ipasir::ipasir_learn_callback(exporting, clause.data());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(LearnedClauseEvaluationCallback)->Arg(3)->Arg(10)->Arg(100);
+
+static void VirtualStackAdd(benchmark::State& state) {
+	unsigned n = state.range(0);
+	FingerprintDecorator solver(
+		std::make_unique<LearnedClauseEvaluationDecorator>(
+			std::make_unique<ipasir::Solver>()));
+
+	unsigned numLiterals = 0;
+	while (state.KeepRunning()) {
+		numLiterals = addPHP(solver, n);
+	}
+	state.SetItemsProcessed(state.iterations() * numLiterals);
+}
+BENCHMARK(VirtualStackAdd)->Arg(10)->Arg(20)->Arg(40);
+
+static void StaticStackAdd(benchmark::State& state) {
+	unsigned n = state.range(0);
+	SolverStack<ipasir::Solver, FingerprintLayer, LearnedClauseEvaluationLayer>
+		::type solver;
+
+	unsigned numLiterals = 0;
+	while (state.KeepRunning()) {
+		numLiterals = addPHP(solver, n);
+	}
+	state.SetItemsProcessed(state.iterations() * numLiterals);
+}
+BENCHMARK(StaticStackAdd)->Arg(10)->Arg(20)->Arg(40);
@@ -0,0 +1,31 @@
+# Use an installed google benchmark if there is one, otherwise download and
+# unpack it at configure time. Sets BENCHMARK_LIBRARIES.
+find_package(benchmark QUIET)
+
+if (benchmark_FOUND)
+  set(BENCHMARK_LIBRARIES benchmark::benchmark)
+else()
+  configure_file(${CMAKE_SOURCE_DIR}/external/cmake/benchmark-download.cmake benchmark-download/CMakeLists.txt)
+  execute_process(COMMAND ${CMAKE_COMMAND} -G "${CMAKE_GENERATOR}" .
+    RESULT_VARIABLE result
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark-download )
+  if(result)
+    message(FATAL_ERROR "CMake step for benchmark failed: ${result}")
+  endif()
+  execute_process(COMMAND ${CMAKE_COMMAND} --build .
+    RESULT_VARIABLE result
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark-download )
+  if(result)
+    message(FATAL_ERROR "Build step for benchmark failed: ${result}")
+  endif()
+
+  # Neither build the tests of the benchmark library nor fetch gtest for them.
+  set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+  set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+  set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+  add_subdirectory(${CMAKE_BINARY_DIR}/benchmark-src
+                   ${CMAKE_BINARY_DIR}/benchmark-build)
+
+  set(BENCHMARK_LIBRARIES benchmark)
+endif()
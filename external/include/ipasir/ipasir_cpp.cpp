@@ -1,5 +1,8 @@
 #include "ipasir_cpp.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace ipasir {
 	int ipasir_terminate_callback(void* state) {
 		return static_cast<Solver*>(state)->terminateCallback();
@@ -10,28 +13,64 @@ namespace ipasir {
 	}
 
 	void ipasir_learn_callback(void* state, int* clause) {
-		static_cast<Solver*>(state)->learnedClauseCallback(clause);
+		static_cast<Solver*>(state)->learned(clause);
 	}
 
-	Solver::Solver():
+	Solver::Solver(bool _consumeOnThread):
 		solver(nullptr),
 		terminateCallback([]{return 0;}),
 		selectLiteralCallback([]{return 0;}),
-		learnedClauseCallback([](int*){return;}) {
+		learnedClauseCallback([](int*, int*){return;}),
+		consumeOnThread(_consumeOnThread),
+		stopConsumer(false) {
 
 		reset();
 	}
 
 	Solver::~Solver(){
+		// the callbacks may refer to layers which are already destroyed,
+		// clauses which are still buffered are dropped
+		stopConsumer = true;
+		if (consumer.joinable()) {
+			consumer.join();
+		}
 		ipasir_release(solver);
 	}
 
-	std::string Solver::signature() {
-		return ipasir_signature();
+	void Solver::learned(int* clause) {
+		std::size_t length = 0;
+		while (clause[length] != 0) {
+			length++;
+		}
+
+		if (learnedClauses.push(clause, length)) {
+			return;
+		}
+
+		consumeLearned();
+		if (!learnedClauses.push(clause, length)) {
+			std::lock_guard<std::mutex> lock(consumerMutex);
+			oversizedClause.assign(clause, clause + length + 1);
+			learnedClauseCallback(oversizedClause.data(),
+				oversizedClause.data() + oversizedClause.size());
+		}
+	}
+
+	bool Solver::consumeLearned() {
+		std::lock_guard<std::mutex> lock(consumerMutex);
+		return learnedClauses.drain(learnedClauseCallback) > 0;
+	}
+
+	void Solver::consumeLoop() {
+		while (!stopConsumer) {
+			if (!consumeLearned()) {
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		}
 	}
 
-	void Solver::add(int lit_or_zero) {
-		ipasir_add(solver, lit_or_zero);
+	std::string Solver::signature() {
+		return ipasir_signature();
 	}
 
 	void Ipasir::addClause(std::vector<int> clause) {
@@ -41,12 +80,10 @@ namespace ipasir {
 		this->add(0);
 	}
 
-	void Solver::assume(int lit) {
-		ipasir_assume(solver, lit);
-	}
-
 	SolveResult Solver::solve() {
-		return static_cast<SolveResult>(ipasir_solve(solver));
+		SolveResult result = static_cast<SolveResult>(ipasir_solve(solver));
+		consumeLearned();
+		return result;
 	}
 
 	int Solver::val(int lit) {
@@ -63,14 +100,48 @@ namespace ipasir {
 	}
 
 	void Solver::set_learn (int max_length, std::function<void(int*)> callback) {
-		learnedClauseCallback = callback;
+		set_learn_batch(max_length, [callback](int* begin, int* end) {
+			forEachClause(begin, end, callback);
+		});
+	}
+
+	void Solver::set_learn_batch (int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		consumeLearned();
+		{
+			std::lock_guard<std::mutex> lock(consumerMutex);
+			learnedClauseCallback = callback;
+
+			// large enough that every clause up to max_length fits, larger
+			// clauses are passed directly
+			std::size_t length = (max_length > 0)? max_length : 0;
+			std::size_t capacity = std::min<std::size_t>(
+				length * 2 + 4, 1 << 22);
+			if (capacity < LearnedClauseRing::defaultCapacity) {
+				capacity = LearnedClauseRing::defaultCapacity;
+			}
+			if (capacity != learnedClauses.capacity()) {
+				learnedClauses.resize(capacity);
+			}
+		}
+
+		if (consumeOnThread && !consumer.joinable()) {
+			consumer = std::thread(&Solver::consumeLoop, this);
+		}
+
 		//#ifdef IPASIR_LEARNED_CLAUSE_CALLBACK
 			ipasir_set_learn(this->solver, this, max_length, &ipasir_learn_callback);
 		//#endif
 	}
 
+	void Solver::set_select_literal (std::function<int(void)> callback) {
+		// registered with the solver on reset
+		selectLiteralCallback = callback;
+	}
+
 	void Solver::reset() {
 		if (solver != nullptr) {
+			consumeLearned();
 			ipasir_release(solver);
 		}
 		solver = ipasir_init();
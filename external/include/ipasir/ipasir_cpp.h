@@ -4,8 +4,14 @@ extern "C" {
 	#include "ipasir/ipasir.h"
 }
 
+#include "ipasir/learned_clause_ring.h"
+
+#include <atomic>
 #include <string>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace ipasir {
@@ -118,17 +124,72 @@ public:
 	 */
 	virtual void set_learn (int max_length, std::function<void(int*)>) = 0;
 
+	/**
+	 * Like set_learn, but the callback gets a batch of learned clauses
+	 * [begin, end), which are stored consecutively and each terminated by 0.
+	 * The callback may modify the clauses in place. All clauses learned
+	 * during a call of solve are passed before it returns.
+	 *
+	 * By default each clause is passed as a batch of its own.
+	 */
+	virtual void set_learn_batch (int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		set_learn(max_length, [callback](int* clause) {
+			int* end = clause;
+			while (*end != 0) {
+				end++;
+			}
+			callback(clause, end + 1);
+		});
+	}
+
+	/**
+	 * Set a callback which the solver calls before each decision. It returns
+	 * a literal to branch on, or 0 to let the solver use its own heuristic.
+	 * The solver calls it again if the returned literal is already assigned,
+	 * so the callback has to return 0 eventually.
+	 *
+	 * Only solvers implementing the extended ipasir interface call it, see
+	 * USE_EXTENDED_IPASIR, all others ignore the callback.
+	 */
+	virtual void set_select_literal (std::function<int(void)>) {
+	}
+
 	virtual void reset() = 0;
 };
 
+/**
+ * Access the next layer of a decorator. The layer is either owned through a
+ * pointer to the interface, so the stack can be assembled at runtime, or held
+ * by value, so calls to it are resolved at compile time.
+ */
+template<class T>
+inline T& layer(T& next) {
+	return next;
+}
+
+template<class T>
+inline T& layer(std::unique_ptr<T>& next) {
+	return *next;
+}
+
 extern "C" {
 	int ipasir_terminate_callback(void* state);
 	int ipasir_select_literal_callback(void* state);
+	void ipasir_learn_callback(void* state, int* clause);
 }
 
+/**
+ * Learned clauses are copied into a ring buffer by the solver and passed on
+ * in batches. The batches are consumed by the thread calling solve when the
+ * buffer is full and before solve returns. With consumeOnThread a separate
+ * thread consumes them while the solver is running, in that case the
+ * callbacks are called concurrently to the solver but never concurrently to
+ * each other.
+ */
 class Solver: public Ipasir {
 public:
-	Solver();
+	explicit Solver(bool consumeOnThread = false);
 
 	virtual ~Solver();
 
@@ -148,16 +209,42 @@ public:
 
 	virtual void set_learn (int max_length, std::function<void(int*)>);
 
+	virtual void set_learn_batch (int max_length,
+		std::function<void(int* begin, int* end)> callback);
+
+	virtual void set_select_literal (std::function<int(void)> callback);
+
 	virtual void reset();
 
 private:
 	void* solver;
 	std::function<int(void)> terminateCallback;
 	std::function<int(void)> selectLiteralCallback;
-	std::function<void(int*)> learnedClauseCallback;
+	std::function<void(int*, int*)> learnedClauseCallback;
+
+	LearnedClauseRing learnedClauses;
+	std::vector<int> oversizedClause;
+	std::mutex consumerMutex;
+	bool consumeOnThread;
+	std::atomic<bool> stopConsumer;
+	std::thread consumer;
+
+	void learned(int* clause);
+	bool consumeLearned();
+	void consumeLoop();
 
 	friend int ipasir_terminate_callback(void* state);
 	friend int ipasir_select_literal_callback(void* state);
 	friend void ipasir_learn_callback(void* state, int* clause);
 };
+
+// add and assume are called for every literal, they are inline so that a
+// solver held by value passes literals straight to ipasir
+inline void Solver::add(int lit_or_zero) {
+	ipasir_add(solver, lit_or_zero);
+}
+
+inline void Solver::assume(int lit) {
+	ipasir_assume(solver, lit);
+}
 }
@@ -0,0 +1,58 @@
+/**
+ * Implementation of the ipasir interface, which ignores all clauses and
+ * reports every formula as unsatisfiable. It allows to link and measure
+ * everything above the solver without a real solver library.
+ */
+
+extern "C" {
+	#include "ipasir/ipasir.h"
+}
+
+namespace {
+	struct NullSolver {
+		int dummy;
+	};
+}
+
+extern "C" {
+	const char * ipasir_signature() {
+		return "ipasir-null";
+	}
+
+	void * ipasir_init() {
+		return new NullSolver();
+	}
+
+	void ipasir_release(void * solver) {
+		delete static_cast<NullSolver*>(solver);
+	}
+
+	void ipasir_add(void *, int) {
+	}
+
+	void ipasir_assume(void *, int) {
+	}
+
+	int ipasir_solve(void *) {
+		return 20;
+	}
+
+	int ipasir_val(void *, int) {
+		return 0;
+	}
+
+	int ipasir_failed(void *, int) {
+		return 0;
+	}
+
+	void ipasir_set_terminate(void *, void *, int (*)(void *)) {
+	}
+
+	void ipasir_set_learn(void *, void *, int, void (*)(void *, int *)) {
+	}
+
+	#ifdef USE_EXTENDED_IPASIR
+	void eipasir_set_select_literal_callback(void *, void *, int (*)(void *)) {
+	}
+	#endif
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace ipasir {
+/**
+ * Calls f for each clause in [begin, end), where the clauses are stored
+ * consecutively and each is terminated by 0.
+ */
+template<class F>
+inline void forEachClause(int* begin, int* end, F&& f) {
+	while (begin != end) {
+		f(begin);
+		while (*begin != 0) {
+			begin++;
+		}
+		begin++;
+	}
+}
+
+/**
+ * Single producer single consumer ring buffer of learned clauses. The
+ * producer copies each clause, including the terminating 0, behind the last
+ * one. A clause is never split, if it does not fit before the end of the
+ * buffer the producer continues at the front. The consumer gets the stored
+ * clauses as at most two contiguous batches and may modify them in place.
+ *
+ * push and drain do not block, push fails if there is not enough space.
+ */
+class LearnedClauseRing {
+public:
+	LearnedClauseRing(std::size_t capacity = defaultCapacity):
+		buffer(capacity),
+		head(0),
+		wrap(0),
+		tail(0)
+	{
+	}
+
+	/**
+	 * Clauses up to this length are guaranteed to fit once the ring is
+	 * drained.
+	 */
+	std::size_t maxLength() const {
+		return buffer.size() / 2 - 2;
+	}
+
+	std::size_t capacity() const {
+		return buffer.size();
+	}
+
+	/**
+	 * Change the capacity, only valid while the ring is empty.
+	 */
+	void resize(std::size_t capacity) {
+		assert(empty());
+		buffer.assign(capacity, 0);
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+	}
+
+	bool empty() const {
+		return head.load(std::memory_order_acquire)
+			== tail.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Copy the clause of the given length and its terminating 0.
+	 */
+	bool push(const int* clause, std::size_t length) {
+		std::size_t size = length + 1;
+		std::size_t h = head.load(std::memory_order_relaxed);
+		std::size_t t = tail.load(std::memory_order_acquire);
+
+		// head never reaches tail from below, so that head == tail is empty
+		std::size_t start;
+		if (h >= t) {
+			if (buffer.size() - h > size) {
+				start = h;
+			} else if (size < t) {
+				wrap.store(h, std::memory_order_relaxed);
+				start = 0;
+			} else {
+				return false;
+			}
+		} else if (h + size < t) {
+			start = h;
+		} else {
+			return false;
+		}
+
+		std::memcpy(&buffer[start], clause, size * sizeof(int));
+		head.store(start + size, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Call consume(begin, end) for the stored clauses and release them.
+	 * Returns the number of released integers.
+	 */
+	template<class Consumer>
+	std::size_t drain(Consumer&& consume) {
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		std::size_t h = head.load(std::memory_order_acquire);
+		std::size_t released = 0;
+
+		if (t > h) {
+			std::size_t w = wrap.load(std::memory_order_relaxed);
+			if (t < w) {
+				consume(&buffer[t], &buffer[w]);
+				released += w - t;
+			}
+			t = 0;
+			tail.store(t, std::memory_order_release);
+		}
+
+		if (t < h) {
+			consume(&buffer[t], &buffer[h]);
+			released += h - t;
+			tail.store(h, std::memory_order_release);
+		}
+		return released;
+	}
+
+	static const std::size_t defaultCapacity = 1 << 16;
+
+private:
+	std::vector<int> buffer;
+
+	// written by the producer, wrap is the end of the clauses before the
+	// producer continued at the front
+	alignas(64) std::atomic<std::size_t> head;
+	std::atomic<std::size_t> wrap;
+	// written by the consumer
+	alignas(64) std::atomic<std::size_t> tail;
+};
+}
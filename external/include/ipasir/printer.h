@@ -1,3 +1,7 @@
+#pragma once
+
+#include "ipasir_cpp.h"
+
 #include <vector>
 #include <iostream>
 
@@ -1,25 +1,45 @@
+#pragma once
+
 #include "ipasir_cpp.h"
 #include <vector>
 
 #include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
 #include <random>
+#include <set>
 
 namespace ipasir {
-class RandomizedSolver : public Ipasir {
+/**
+ * Whether the randomized solver renumbers the variables. With Kept the next
+ * layer sees the variable numbers of the caller and only the order of
+ * clauses, literals and assumptions is shuffled.
+ */
+enum class VariableNumbering {
+	Shuffled, Kept
+};
+
+/**
+ * Shuffles variables, clauses and literals before they are passed to the
+ * next layer. Next is either std::unique_ptr<Ipasir> or a solver type which
+ * is held by value and constructed from the remaining constructor arguments.
+ */
+template<class Next>
+class BasicRandomizedSolver : public Ipasir {
 public:
-	RandomizedSolver(unsigned seed, std::unique_ptr<Ipasir> _solver = std::make_unique<ipasir::Solver>()):
-			solver(std::move(_solver)) {
+	template<class ... Args>
+	BasicRandomizedSolver(unsigned seed, VariableNumbering _numbering,
+			Args&& ... args):
+			solver(std::forward<Args>(args)...),
+			numbering(_numbering) {
 		std::cout << "c [randomizedIpasir] seed: " << seed << std::endl;
 		g = std::mt19937(seed);
 		init();
 	}
 
-	RandomizedSolver(std::unique_ptr<Ipasir> _solver = std::make_unique<ipasir::Solver>()):
-		RandomizedSolver(std::random_device()(), std::move(_solver)){
-	}
-
 	virtual std::string signature(){
-		return solver->signature();
+		return layer(solver).signature();
 	};
 
 	virtual void add(int lit_or_zero) {
@@ -39,7 +59,7 @@ public:
 			return lit;
 		}
 
-		return unmap(solver->val(map(lit)));
+		return unmap(layer(solver).val(map(lit)));
 	};
 
 	virtual int failed (int lit) {
@@ -47,56 +67,68 @@ public:
 			return 0;
 		}
 
-		return solver->failed(map(lit));
+		return layer(solver).failed(map(lit));
 	};
 
 	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
-		this->learnedClauseCallback = callback;
-		solver->set_learn(
-			max_length,
-			std::bind(
-				&RandomizedSolver::mappingCallback,
-				this,
-				std::placeholders::_1));
-	}
-
-	virtual void mappingCallback(int* clause){
-		std::vector<int> mappedClause;
-		for (;*clause != 0; clause++) {
-			mappedClause.push_back(unmap(*clause));
-		}
-		mappedClause.push_back(0);
+		set_learn_batch(max_length, [callback](int* begin, int* end) {
+			forEachClause(begin, end, callback);
+		});
+	}
 
-		learnedClauseCallback(mappedClause.data());
+	virtual void set_learn_batch(int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		layer(solver).set_learn_batch(max_length,
+			[this, callback](int* begin, int* end) {
+				for (int* lit = begin; lit != end; lit++) {
+					*lit = unmap(*lit);
+				}
+				callback(begin, end);
+			});
+	}
+
+	/**
+	 * Literals of variables, which were never passed to the solver, are
+	 * skipped.
+	 */
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		layer(solver).set_select_literal([this, callback]() {
+			int lit = callback();
+			while (lit != 0 && isLiteralUnused(lit)) {
+				lit = callback();
+			}
+			return map(lit);
+		});
 	}
 
 	virtual SolveResult solve() {
 		scrumbleVariables();
 		scrumbleClauses();
 
+		auto& next = layer(solver);
 		for (std::vector<int>& clause: clauses) {
 			for (int lit: clause) {
-				solver->add(map(lit));
+				next.add(map(lit));
 			}
-			solver->add(0);
+			next.add(0);
 		}
 		clauses.clear();
 		clauses.push_back(std::vector<int>());
 
 		for (int literal:assumptions) {
-			solver->assume(map(literal));
+			next.assume(map(literal));
 		}
 		assumptions.clear();
 
-		return solver->solve();
+		return next.solve();
 	}
 
 	virtual void set_terminate (std::function<int(void)> callback) {
-		solver->set_terminate(callback);
+		layer(solver).set_terminate(callback);
 	};
 
 	virtual void reset() {
-		solver->reset();
+		layer(solver).reset();
 		clauses.clear();
 		assumptions.clear();
 		toIpasir.clear();
@@ -106,7 +138,7 @@ public:
 	};
 
 private:
-	std::unique_ptr<Ipasir> solver;
+	Next solver;
 
 	std::vector<std::vector<int>> clauses;
 	std::vector<int> assumptions;
@@ -115,8 +147,7 @@ private:
 	std::vector<unsigned> fromIpasir;
 	std::set<int> knownVariables;
 	std::mt19937 g;
-
-	std::function<void(int*)> learnedClauseCallback;
+	VariableNumbering numbering;
 
 	void init() {
 		clauses.push_back(std::vector<int>());
@@ -151,6 +182,16 @@ private:
 			addLiteral(newVariables, maxVariable, lit);
 		}
 
+		if (numbering == VariableNumbering::Kept) {
+			fromIpasir.resize(maxVariable + 1, 0);
+			toIpasir.resize(maxVariable + 1, 0);
+			for (unsigned var: newVariables) {
+				fromIpasir[var] = var;
+				toIpasir[var] = var;
+			}
+			return;
+		}
+
 		std::shuffle(newVariables.begin(), newVariables.end(), g);
 
 		size_t newStart = fromIpasir.size();
@@ -209,4 +250,17 @@ private:
 		return sign * variable;
 	}
 };
+
+class RandomizedSolver : public BasicRandomizedSolver<std::unique_ptr<Ipasir>> {
+public:
+	RandomizedSolver(unsigned seed, std::unique_ptr<Ipasir> _solver = std::make_unique<ipasir::Solver>(),
+			VariableNumbering numbering = VariableNumbering::Shuffled):
+		BasicRandomizedSolver(seed, numbering, std::move(_solver)) {
+	}
+
+	RandomizedSolver(std::unique_ptr<Ipasir> _solver = std::make_unique<ipasir::Solver>(),
+			VariableNumbering numbering = VariableNumbering::Shuffled):
+		RandomizedSolver(std::random_device()(), std::move(_solver), numbering){
+	}
+};
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "SolveMetrics.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * Streaming hash of an incremental formula. Between two solve calls the
+ * clauses are hashed as a multiset, i.e. neither the order of the clauses
+ * nor the order of the literals within a clause changes the result. The
+ * sequence of assumptions and solve calls is hashed in order, each solve
+ * call includes the clause multiset added before it.
+ *
+ * Nothing is buffered, the state are a few integers.
+ */
+class ClauseFingerprint {
+public:
+	ClauseFingerprint() {
+		reset();
+	}
+
+	void add(int lit_or_zero) {
+		if (lit_or_zero == 0) {
+			clauses += mix(clause + clauseTag);
+			clause = 0;
+		} else {
+			clause += mix(static_cast<std::uint64_t>(
+				static_cast<std::int64_t>(lit_or_zero)));
+		}
+	}
+
+	void assume(int lit) {
+		sequence = mix(sequence ^ mix(assumeTag + static_cast<std::uint64_t>(
+			static_cast<std::int64_t>(lit))));
+	}
+
+	void solve() {
+		sequence = mix(sequence ^ mix(clauses + solveTag));
+		clauses = 0;
+	}
+
+	void reset() {
+		clause = 0;
+		clauses = 0;
+		sequence = 0;
+	}
+
+	/**
+	 * Fingerprint of everything seen so far, clauses which were added
+	 * after the last solve call are included.
+	 */
+	std::uint64_t value() const {
+		return mix(sequence ^ mix(clauses + endTag));
+	}
+
+	std::string toString() const {
+		static const char* digits = "0123456789abcdef";
+		std::uint64_t v = value();
+		std::string result(16, '0');
+		for (unsigned i = 0; i < 16; i++) {
+			result[15 - i] = digits[(v >> (4 * i)) & 0xf];
+		}
+		return result;
+	}
+
+private:
+	static const std::uint64_t clauseTag = 0x9e3779b97f4a7c15ull;
+	static const std::uint64_t assumeTag = 0xc2b2ae3d27d4eb4full;
+	static const std::uint64_t solveTag = 0x165667b19e3779f9ull;
+	static const std::uint64_t endTag = 0x27d4eb2f165667c5ull;
+
+	std::uint64_t clause;
+	std::uint64_t clauses;
+	std::uint64_t sequence;
+
+	/**
+	 * splitmix64 finalizer
+	 */
+	static std::uint64_t mix(std::uint64_t x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return x;
+	}
+};
+
+/**
+ * Computes the ClauseFingerprint of everything the encoder emits and
+ * writes it to /incphp/result/fingerprint. Next is either
+ * std::unique_ptr<Ipasir> or a solver type held by value.
+ */
+template<class Next>
+class BasicFingerprintDecorator: public ipasir::Ipasir {
+public:
+	template<class ... Args>
+	BasicFingerprintDecorator(Args&& ... args):
+			solver(std::forward<Args>(args)...) {
+	}
+
+	virtual ~BasicFingerprintDecorator() {
+		updateLoggedData();
+		LOG(INFO) << "fingerprint: " << fingerprint.toString();
+	}
+
+	virtual std::string signature() {
+		return ipasir::layer(solver).signature();
+	}
+
+	virtual void add(int lit_or_zero) {
+		fingerprint.add(lit_or_zero);
+		ipasir::layer(solver).add(lit_or_zero);
+	}
+
+	virtual void assume(int lit) {
+		fingerprint.assume(lit);
+		ipasir::layer(solver).assume(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		fingerprint.solve();
+		updateLoggedData();
+		return ipasir::layer(solver).solve();
+	}
+
+	virtual int val(int lit) {
+		return ipasir::layer(solver).val(lit);
+	}
+
+	virtual int failed(int lit) {
+		return ipasir::layer(solver).failed(lit);
+	}
+
+	virtual void set_terminate(std::function<int(void)> callback) {
+		ipasir::layer(solver).set_terminate(callback);
+	}
+
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		ipasir::layer(solver).set_select_literal(callback);
+	}
+
+	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
+		ipasir::layer(solver).set_learn(max_length, callback);
+	}
+
+	virtual void set_learn_batch(int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		ipasir::layer(solver).set_learn_batch(max_length, callback);
+	}
+
+	virtual void reset() {
+		ipasir::layer(solver).reset();
+		fingerprint.reset();
+	}
+
+	const ClauseFingerprint& getFingerprint() {
+		return fingerprint;
+	}
+
+private:
+	Next solver;
+	ClauseFingerprint fingerprint;
+
+	void updateLoggedData() {
+		SolveMetrics::current().result("fingerprint") = fingerprint.toString();
+	}
+};
+
+typedef BasicFingerprintDecorator<std::unique_ptr<ipasir::Ipasir>>
+	FingerprintDecorator;
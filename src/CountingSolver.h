@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "SolveMetrics.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Backend which does not solve but only counts what the encoder emits, to
+ * measure encoding throughput without solver cost. Every solve reports
+ * UNSAT with all assumptions failed.
+ */
+class CountingSolver: public ipasir::Ipasir {
+public:
+	CountingSolver() {
+		init();
+	}
+
+	virtual ~CountingSolver() {
+		updateLoggedData();
+		LOG(INFO) << "clauses: " << numClauses
+			<< " literals: " << numLiterals
+			<< " assumptions: " << numAssumptions
+			<< " solves: " << numSolves;
+	}
+
+	virtual std::string signature() {
+		return "ipasir-counting";
+	}
+
+	virtual void add(int lit_or_zero) {
+		if (lit_or_zero == 0) {
+			numClauses += 1;
+		} else {
+			numLiterals += 1;
+		}
+	}
+
+	virtual void assume(int lit) {
+		numAssumptions += 1;
+		assumptions.push_back(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		numSolves += 1;
+		lastAssumptions.swap(assumptions);
+		assumptions.clear();
+
+		updateLoggedData();
+		return ipasir::SolveResult::UNSAT;
+	}
+
+	virtual int val(int) {
+		return 0;
+	}
+
+	virtual int failed(int lit) {
+		for (int assumed: lastAssumptions) {
+			if (assumed == lit) {
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+	virtual void set_terminate(std::function<int(void)>) {
+	}
+
+	virtual void set_learn(int, std::function<void(int*)>) {
+	}
+
+	virtual void reset() {
+		init();
+	}
+
+private:
+	std::uint64_t numClauses;
+	std::uint64_t numLiterals;
+	std::uint64_t numAssumptions;
+	std::uint64_t numSolves;
+
+	std::vector<int> assumptions;
+	std::vector<int> lastAssumptions;
+
+	std::chrono::time_point<std::chrono::steady_clock> start;
+
+	void init() {
+		numClauses = 0;
+		numLiterals = 0;
+		numAssumptions = 0;
+		numSolves = 0;
+		assumptions.clear();
+		lastAssumptions.clear();
+		start = std::chrono::steady_clock::now();
+	}
+
+	void updateLoggedData() {
+		auto& counts = SolveMetrics::current().result("counting");
+
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+
+		counts["numClauses"] = numClauses;
+		counts["numLiterals"] = numLiterals;
+		counts["numAssumptions"] = numAssumptions;
+		counts["numSolves"] = numSolves;
+		counts["time"] = elapsed.count();
+		if (elapsed.count() > 0) {
+			counts["clausesPerSecond"] = numClauses / elapsed.count();
+		}
+	}
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "PHPEncoder.h"
+#include "SolveMetrics.h"
+#include "ipasir/ipasir_cpp.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Solves one pigeon hole instance in parallel by splitting it on the
+ * placement of pigeons. A cube fixes the hole of the first pigeons, where
+ * each pigeon is either in one of the holes or in none of them, so the
+ * cubes of one split cover all assignments.
+ *
+ * Each worker owns an encoder with its own solver and a deque of cubes. A
+ * worker takes cubes from the back of its own deque and steals from the
+ * front of the others. Cubes which are not solved within the timeout are
+ * split on the next pigeon, cubes which can not be split further are solved
+ * again with twice the timeout.
+ *
+ * Workers do not log, easylogging is not built thread safe.
+ */
+class CubeAndConquer {
+public:
+	typedef std::function<std::unique_ptr<UniversalPHPEncoder>(unsigned worker)>
+		EncoderFactory;
+
+	CubeAndConquer(
+			unsigned _numPigeons,
+			unsigned _numWorkers,
+			double _timeout,
+			unsigned _initialDepth,
+			EncoderFactory _createEncoder):
+		numPigeons(_numPigeons),
+		numWorkers(std::max(1u, _numWorkers)),
+		timeout(_timeout),
+		initialDepth(std::min(std::max(1u, _initialDepth), _numPigeons)),
+		createEncoder(_createEncoder)
+	{
+	}
+
+	/**
+	 * Returns true if one of the cubes is satisfiable.
+	 */
+	bool solve() {
+		auto start = std::chrono::steady_clock::now();
+
+		foundSat = false;
+		numOpen = 0;
+		numSplits = 0;
+		queues = std::vector<Queue>(numWorkers);
+		workerResults = std::vector<std::vector<CubeResult>>(numWorkers);
+
+		std::vector<Cube> initial;
+		split(Cube(), initialDepth, initial);
+		for (unsigned i = 0; i < initial.size(); i++) {
+			push(i % numWorkers, std::move(initial[i]));
+		}
+
+		std::vector<std::thread> workers;
+		for (unsigned i = 0; i < numWorkers; i++) {
+			workers.emplace_back(&CubeAndConquer::work, this, i);
+		}
+		for (std::thread& worker: workers) {
+			worker.join();
+		}
+
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		updateLoggedData(elapsed.count(), initial.size());
+		return foundSat;
+	}
+
+private:
+	/**
+	 * A cube is the hole of each of the first pigeons, the number of holes
+	 * stands for none of the holes.
+	 */
+	typedef std::vector<unsigned> Cube;
+
+	struct Task {
+		Cube cube;
+		double timeout;
+	};
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	struct CubeResult {
+		Cube cube;
+		unsigned worker;
+		double time;
+		ipasir::SolveResult result;
+	};
+
+	unsigned numPigeons;
+	unsigned numWorkers;
+	double timeout;
+	unsigned initialDepth;
+	EncoderFactory createEncoder;
+
+	std::vector<Queue> queues;
+	std::vector<std::vector<CubeResult>> workerResults;
+	std::atomic<bool> foundSat;
+	std::atomic<unsigned> numOpen;
+	std::atomic<unsigned> numSplits;
+
+	std::mutex idleMutex;
+	std::condition_variable idle;
+
+	unsigned numHoles() const {
+		return numPigeons - 1;
+	}
+
+	/**
+	 * Add all extensions of cube to the given depth to result.
+	 */
+	void split(Cube cube, unsigned depth, std::vector<Cube>& result) {
+		if (cube.size() >= depth) {
+			result.push_back(cube);
+			return;
+		}
+		for (unsigned hole = 0; hole <= numHoles(); hole++) {
+			cube.push_back(hole);
+			split(cube, depth, result);
+			cube.pop_back();
+		}
+	}
+
+	std::vector<int> literals(UniversalPHPEncoder& encoder, const Cube& cube) {
+		std::vector<int> result;
+		for (unsigned pigeon = 0; pigeon < cube.size(); pigeon++) {
+			if (cube[pigeon] < numHoles()) {
+				result.push_back(
+					encoder.getVar()->pigeonInHole(pigeon, cube[pigeon]));
+			} else {
+				for (unsigned hole = 0; hole < numHoles(); hole++) {
+					result.push_back(
+						-encoder.getVar()->pigeonInHole(pigeon, hole));
+				}
+			}
+		}
+		return result;
+	}
+
+	void push(unsigned worker, Cube cube, double cubeTimeout = 0) {
+		numOpen += 1;
+		{
+			std::lock_guard<std::mutex> lock(queues[worker].mutex);
+			queues[worker].tasks.push_back({std::move(cube),
+				(cubeTimeout > 0) ? cubeTimeout : timeout});
+		}
+		idle.notify_all();
+	}
+
+	bool pop(unsigned worker, Task& task) {
+		for (unsigned i = 0; i < numWorkers; i++) {
+			Queue& queue = queues[(worker + i) % numWorkers];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				if (i == 0) {
+					task = std::move(queue.tasks.back());
+					queue.tasks.pop_back();
+				} else {
+					task = std::move(queue.tasks.front());
+					queue.tasks.pop_front();
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void finished() {
+		if (--numOpen == 0) {
+			std::lock_guard<std::mutex> lock(idleMutex);
+			idle.notify_all();
+		}
+	}
+
+	void work(unsigned worker) {
+		std::unique_ptr<UniversalPHPEncoder> encoder = createEncoder(worker);
+		encoder->encode();
+
+		std::chrono::time_point<std::chrono::steady_clock> deadline;
+		encoder->setTerminate([this, &deadline]() -> int {
+			return foundSat || std::chrono::steady_clock::now() > deadline;
+		});
+
+		Task task;
+		while (!foundSat) {
+			if (!pop(worker, task)) {
+				std::unique_lock<std::mutex> lock(idleMutex);
+				if (numOpen == 0) {
+					break;
+				}
+				idle.wait_for(lock, std::chrono::milliseconds(10));
+				continue;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			deadline = start + std::chrono::duration_cast<
+				std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(task.timeout));
+			ipasir::SolveResult result =
+				encoder->solveCube(literals(*encoder, task.cube));
+			std::chrono::duration<double> elapsed =
+				std::chrono::steady_clock::now() - start;
+
+			workerResults[worker].push_back(
+				{task.cube, worker, elapsed.count(), result});
+
+			if (result == ipasir::SolveResult::SAT) {
+				foundSat = true;
+			} else if (result == ipasir::SolveResult::TIMEOUT && !foundSat) {
+				if (task.cube.size() < numPigeons) {
+					numSplits += 1;
+					std::vector<Cube> cubes;
+					split(task.cube, task.cube.size() + 1, cubes);
+					for (Cube& cube: cubes) {
+						push(worker, std::move(cube));
+					}
+				} else {
+					push(worker, task.cube, 2 * task.timeout);
+				}
+			}
+			finished();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+			idle.notify_all();
+		}
+	}
+
+	void updateLoggedData(double time, unsigned numInitialCubes) {
+		auto& cubes = SolveMetrics::current().result("cubes");
+		auto& summary = SolveMetrics::current().result("cubeAndConquer");
+
+		cubes = nlohmann::json::array();
+		unsigned numSolved = 0;
+		unsigned numTimeouts = 0;
+		for (auto& results: workerResults) {
+			for (CubeResult& result: results) {
+				nlohmann::json entry;
+				entry["cube"] = result.cube;
+				entry["worker"] = result.worker;
+				entry["time"] = result.time;
+				entry["result"] = static_cast<int>(result.result);
+				cubes.push_back(entry);
+
+				if (result.result == ipasir::SolveResult::TIMEOUT) {
+					numTimeouts += 1;
+				} else {
+					numSolved += 1;
+				}
+			}
+		}
+
+		summary["numWorkers"] = numWorkers;
+		summary["numInitialCubes"] = numInitialCubes;
+		summary["numSolvedCubes"] = numSolved;
+		summary["numTimeouts"] = numTimeouts;
+		summary["numSplits"] = numSplits.load();
+		summary["sat"] = foundSat.load();
+		summary["time"] = time;
+
+		LOG(INFO) << "cubes solved: " << numSolved
+			<< " timeouts: " << numTimeouts
+			<< " splits: " << numSplits.load()
+			<< " time: " << time << "s";
+	}
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * A fixed order of decision literals for Ipasir::set_select_literal. The
+ * solver calls select again while the returned literal is assigned, so a
+ * scan from the first literal of the order resumes at the first unassigned
+ * one. The call after a returned 0 always starts a new decision, which is
+ * where scans start.
+ *
+ * Once a scan reaches the end, everything in the order is assigned and 0
+ * is returned directly, so the solver decides on its own. Backjumps unassign
+ * literals again without telling the callback, so a new scan starts after
+ * as many own decisions as the order has literals, which costs at most one
+ * call per decision. rewind() starts a scan right away, i.e. before a solve.
+ */
+class DecisionOrder {
+public:
+	DecisionOrder(std::vector<int> _order):
+		order(std::move(_order)),
+		position(0),
+		numIdle(0),
+		numCalls(0),
+		numRounds(0)
+	{
+	}
+
+	int select() {
+		numCalls += 1;
+		if (numIdle > 0) {
+			numIdle -= 1;
+			return 0;
+		}
+		if (position == order.size()) {
+			position = 0;
+			numIdle = order.size();
+			numRounds += 1;
+			return 0;
+		}
+		return order[position++];
+	}
+
+	void rewind() {
+		position = 0;
+		numIdle = 0;
+	}
+
+	std::size_t size() const {
+		return order.size();
+	}
+
+	std::uint64_t getNumCalls() const {
+		return numCalls;
+	}
+
+	std::uint64_t getNumRounds() const {
+		return numRounds;
+	}
+
+private:
+	std::vector<int> order;
+	std::size_t position;
+	std::size_t numIdle;
+	std::uint64_t numCalls;
+	std::uint64_t numRounds;
+};
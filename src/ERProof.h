@@ -0,0 +1,549 @@
+#pragma once
+
+#include "SatVariable.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Receives a formula and its refutation clause by clause.
+ */
+class ProofSink {
+public:
+	virtual ~ProofSink() = default;
+
+	virtual void begin(unsigned /*numVariables*/, unsigned /*numClauses*/) {
+	}
+
+	virtual void original(const std::vector<int>& clause) = 0;
+
+	/**
+	 * A clause which is RUP or, for extension variables, RAT on its first
+	 * literal.
+	 */
+	virtual void lemma(const std::vector<int>& clause) = 0;
+
+	virtual void remove(const std::vector<int>& clause) = 0;
+};
+
+/**
+ * Writes the original clauses in DIMACS format.
+ */
+class DimacsWriter: public ProofSink {
+public:
+	DimacsWriter(std::ostream& _out):
+		out(_out) {
+	}
+
+	virtual void begin(unsigned numVariables, unsigned numClauses) {
+		out << "p cnf " << numVariables << " " << numClauses << "\n";
+	}
+
+	virtual void original(const std::vector<int>& clause) {
+		for (int lit: clause) {
+			out << lit << " ";
+		}
+		out << "0\n";
+	}
+
+	virtual void lemma(const std::vector<int>&) {
+	}
+
+	virtual void remove(const std::vector<int>&) {
+	}
+
+private:
+	std::ostream& out;
+};
+
+/**
+ * Writes lemmas and deletions in binary DRAT format: 'a' or 'd' followed by
+ * the literals as variable length numbers 2 * var + sign and a zero byte.
+ */
+class DratWriter: public ProofSink {
+public:
+	DratWriter(std::ostream& _out):
+		out(_out),
+		numLemmas(0),
+		numDeletions(0),
+		numBytes(0) {
+	}
+
+	virtual void original(const std::vector<int>&) {
+	}
+
+	virtual void lemma(const std::vector<int>& clause) {
+		numLemmas += 1;
+		write('a', clause);
+	}
+
+	virtual void remove(const std::vector<int>& clause) {
+		numDeletions += 1;
+		write('d', clause);
+	}
+
+	std::uint64_t getNumLemmas() const {
+		return numLemmas;
+	}
+
+	std::uint64_t getNumDeletions() const {
+		return numDeletions;
+	}
+
+	std::uint64_t getNumBytes() const {
+		return numBytes;
+	}
+
+private:
+	std::ostream& out;
+	std::uint64_t numLemmas;
+	std::uint64_t numDeletions;
+	std::uint64_t numBytes;
+
+	void write(char type, const std::vector<int>& clause) {
+		out.put(type);
+		numBytes += 1;
+		for (int lit: clause) {
+			std::uint64_t value = 2 * static_cast<std::uint64_t>(std::abs(lit))
+				+ (lit < 0);
+			while (value > 127) {
+				out.put(static_cast<char>((value & 127) | 128));
+				value >>= 7;
+				numBytes += 1;
+			}
+			out.put(static_cast<char>(value));
+			numBytes += 1;
+		}
+		out.put(0);
+		numBytes += 1;
+	}
+};
+
+/**
+ * Forward checker: every lemma is checked against the clauses which are
+ * present when it is added. A lemma is accepted if it is RUP or RAT on its
+ * first literal. Unit propagation uses two watched literals, deleting a
+ * unit or reason clause does not undo its top level assignment.
+ */
+class RupChecker: public ProofSink {
+public:
+	RupChecker():
+		inconsistent(false),
+		failed(false),
+		numChecked(0),
+		qhead(0) {
+	}
+
+	virtual void original(const std::vector<int>& clause) {
+		addClause(clause);
+	}
+
+	virtual void lemma(const std::vector<int>& clause) {
+		if (failed) {
+			return;
+		}
+		numChecked += 1;
+		if (!isRup(clause) && !isRat(clause)) {
+			failed = true;
+			failedLemma = clause;
+			return;
+		}
+		addClause(clause);
+	}
+
+	virtual void remove(const std::vector<int>& clause) {
+		auto it = index.find(sorted(clause));
+		if (it == index.end() || it->second.empty()) {
+			return;
+		}
+		deleted[it->second.back()] = true;
+		it->second.pop_back();
+	}
+
+	/**
+	 * True if all lemmas were accepted and the empty clause was derived.
+	 */
+	bool refuted() const {
+		return !failed && inconsistent;
+	}
+
+	bool hasFailed() const {
+		return failed;
+	}
+
+	const std::vector<int>& getFailedLemma() const {
+		return failedLemma;
+	}
+
+	std::uint64_t getNumChecked() const {
+		return numChecked;
+	}
+
+private:
+	std::vector<std::vector<int>> clauses;
+	std::vector<bool> deleted;
+	std::map<std::vector<int>, std::vector<unsigned>> index;
+	std::vector<std::vector<unsigned>> watches;
+	std::vector<std::vector<unsigned>> occurs;
+	std::vector<signed char> assignment;
+	std::vector<int> trail;
+
+	bool inconsistent;
+	bool failed;
+	std::vector<int> failedLemma;
+	std::uint64_t numChecked;
+	unsigned qhead;
+
+	static unsigned code(int lit) {
+		return 2 * static_cast<unsigned>(std::abs(lit)) + (lit < 0);
+	}
+
+	static std::vector<int> sorted(std::vector<int> clause) {
+		std::sort(clause.begin(), clause.end());
+		return clause;
+	}
+
+	void ensureVar(int var) {
+		unsigned size = static_cast<unsigned>(var) + 1;
+		if (size > assignment.size()) {
+			assignment.resize(size, 0);
+			watches.resize(2 * size);
+			occurs.resize(2 * size);
+		}
+	}
+
+	signed char value(int lit) const {
+		signed char v = assignment[std::abs(lit)];
+		return (lit < 0) ? -v : v;
+	}
+
+	void assign(int lit) {
+		assignment[std::abs(lit)] = (lit > 0) ? 1 : -1;
+		trail.push_back(lit);
+	}
+
+	void backtrack(unsigned size) {
+		while (trail.size() > size) {
+			assignment[std::abs(trail.back())] = 0;
+			trail.pop_back();
+		}
+		qhead = size;
+	}
+
+	void addClause(std::vector<int> clause) {
+		for (int lit: clause) {
+			ensureVar(std::abs(lit));
+		}
+		if (inconsistent) {
+			return;
+		}
+
+		unsigned id = clauses.size();
+		index[sorted(clause)].push_back(id);
+		for (int lit: clause) {
+			occurs[code(lit)].push_back(id);
+		}
+
+		// move the two best literals to the front: true, then unassigned
+		auto rank = [this](int lit) {
+			return (value(lit) > 0) ? 0 : (value(lit) == 0 ? 1 : 2);
+		};
+		for (unsigned w = 0; w < 2 && w < clause.size(); w++) {
+			for (unsigned i = w + 1; i < clause.size(); i++) {
+				if (rank(clause[i]) < rank(clause[w])) {
+					std::swap(clause[i], clause[w]);
+				}
+			}
+		}
+
+		clauses.push_back(clause);
+		deleted.push_back(false);
+
+		if (clause.empty() || value(clause[0]) < 0) {
+			inconsistent = true;
+			return;
+		}
+		if (clause.size() == 1 || value(clause[1]) < 0) {
+			if (value(clause[0]) == 0) {
+				assign(clause[0]);
+				if (!propagate()) {
+					inconsistent = true;
+					return;
+				}
+			}
+		}
+		if (clause.size() > 1) {
+			watches[code(-clause[0])].push_back(id);
+			watches[code(-clause[1])].push_back(id);
+		}
+	}
+
+	/**
+	 * Returns false on conflict.
+	 */
+	bool propagate() {
+		while (qhead < trail.size()) {
+			int lit = trail[qhead++];
+			std::vector<unsigned>& watchList = watches[code(lit)];
+			unsigned j = 0;
+			for (unsigned i = 0; i < watchList.size(); i++) {
+				unsigned id = watchList[i];
+				if (deleted[id]) {
+					continue;
+				}
+				std::vector<int>& clause = clauses[id];
+				if (clause[0] == -lit) {
+					std::swap(clause[0], clause[1]);
+				}
+
+				if (value(clause[0]) > 0) {
+					watchList[j++] = id;
+					continue;
+				}
+
+				bool moved = false;
+				for (unsigned k = 2; k < clause.size(); k++) {
+					if (value(clause[k]) >= 0) {
+						std::swap(clause[1], clause[k]);
+						watches[code(-clause[1])].push_back(id);
+						moved = true;
+						break;
+					}
+				}
+				if (moved) {
+					continue;
+				}
+
+				watchList[j++] = id;
+				if (value(clause[0]) < 0) {
+					for (i++; i < watchList.size(); i++) {
+						watchList[j++] = watchList[i];
+					}
+					watchList.resize(j);
+					return false;
+				}
+				assign(clause[0]);
+			}
+			watchList.resize(j);
+		}
+		return true;
+	}
+
+	bool isRup(const std::vector<int>& clause) {
+		if (inconsistent) {
+			return true;
+		}
+		for (int lit: clause) {
+			ensureVar(std::abs(lit));
+		}
+
+		unsigned level = trail.size();
+		bool conflict = false;
+		for (int lit: clause) {
+			if (value(lit) > 0) {
+				conflict = true;
+				break;
+			} else if (value(lit) == 0) {
+				assign(-lit);
+			}
+		}
+		if (!conflict) {
+			conflict = !propagate();
+		}
+		backtrack(level);
+		return conflict;
+	}
+
+	bool isRat(const std::vector<int>& clause) {
+		if (clause.empty()) {
+			return false;
+		}
+		int pivot = clause[0];
+		std::vector<unsigned> candidates = occurs[code(-pivot)];
+		for (unsigned id: candidates) {
+			if (deleted[id]) {
+				continue;
+			}
+			std::vector<int> resolvent = clause;
+			for (int lit: clauses[id]) {
+				if (lit != -pivot) {
+					resolvent.push_back(lit);
+				}
+			}
+			if (!isRup(resolvent)) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ * Cook's extended resolution refutation of the pigeon hole principle. The
+ * formula of layer m states that m pigeons fit into m - 1 holes. Layer
+ * m - 1 is defined by
+ *     Q(i, j) <-> P(i, j) v (P(i, m - 2) ^ P(m - 1, j))
+ * i.e. pigeon i takes the hole of the last pigeon if it sits in the last
+ * hole. The clauses of layer m - 1 are derived by RUP from layer m, layer 2
+ * is refuted by unit propagation.
+ *
+ * The size of the proof is O(n^4) clauses of at most three literals for the
+ * lemmas, no search is involved.
+ */
+class ERProofEmitter {
+public:
+	ERProofEmitter(unsigned _numPigeons):
+		numPigeons(_numPigeons) {
+		// top layer first, so the variables of the formula are 1..n(n-1)
+		for (unsigned m = numPigeons; m >= 2; m--) {
+			layers.push_back(allocator.newVariable(m, m - 1));
+		}
+	}
+
+	void emit(const std::vector<ProofSink*>& _sinks) {
+		sinks = _sinks;
+		unsigned n = numPigeons;
+		for (ProofSink* sink: sinks) {
+			sink->begin(n * (n - 1), n + (n - 1) * n * (n - 1) / 2);
+		}
+
+		for (unsigned i = 0; i < n; i++) {
+			original(atLeastOne(n, i));
+		}
+		for (unsigned j = 0; j + 1 < n; j++) {
+			for (unsigned k = 1; k < n; k++) {
+				for (unsigned i = 0; i < k; i++) {
+					original(atMostOne(n, i, k, j));
+				}
+			}
+		}
+
+		for (unsigned m = n; m > 2; m--) {
+			deriveLayer(m - 1);
+			removePhp(m);
+			if (m < n) {
+				removeDefinitions(m);
+			}
+		}
+
+		lemma({});
+	}
+
+private:
+	unsigned numPigeons;
+	SatVariableAllocator allocator;
+	std::vector<SatVariable<unsigned, unsigned>> layers;
+	std::vector<ProofSink*> sinks;
+
+	/**
+	 * Pigeon i sits in hole j in layer m.
+	 */
+	int P(unsigned m, unsigned i, unsigned j) {
+		return layers[numPigeons - m](i, j);
+	}
+
+	std::vector<int> atLeastOne(unsigned m, unsigned i) {
+		std::vector<int> clause;
+		for (unsigned j = 0; j + 1 < m; j++) {
+			clause.push_back(P(m, i, j));
+		}
+		return clause;
+	}
+
+	std::vector<int> atMostOne(unsigned m, unsigned i, unsigned k, unsigned j) {
+		return {-P(m, i, j), -P(m, k, j)};
+	}
+
+	/**
+	 * The definition clauses of P(m, i, j), each is RAT on its first literal.
+	 */
+	std::vector<std::vector<int>> definitions(unsigned m, unsigned i,
+			unsigned j) {
+		int q = P(m, i, j);
+		int p = P(m + 1, i, j);
+		int pLastHole = P(m + 1, i, m - 1);
+		int lastPigeon = P(m + 1, m, j);
+		return {
+			{ q, -p},
+			{ q, -pLastHole, -lastPigeon},
+			{-q,  p,  pLastHole},
+			{-q,  p,  lastPigeon}
+		};
+	}
+
+	void deriveLayer(unsigned m) {
+		for (unsigned i = 0; i < m; i++) {
+			for (unsigned j = 0; j + 1 < m; j++) {
+				for (std::vector<int>& clause: definitions(m, i, j)) {
+					lemma(clause);
+				}
+			}
+		}
+
+		for (unsigned i = 0; i < m; i++) {
+			lemma(atLeastOne(m, i));
+		}
+
+		for (unsigned j = 0; j + 1 < m; j++) {
+			for (unsigned k = 1; k < m; k++) {
+				for (unsigned i = 0; i < k; i++) {
+					int qi = P(m, i, j);
+					int qk = P(m, k, j);
+					std::vector<int> first = {-qi, -qk, -P(m + 1, i, j)};
+					std::vector<int> second = {-qi, -qk, -P(m + 1, k, j)};
+					lemma(first);
+					lemma(second);
+					lemma(atMostOne(m, i, k, j));
+					remove(first);
+					remove(second);
+				}
+			}
+		}
+	}
+
+	void removePhp(unsigned m) {
+		for (unsigned i = 0; i < m; i++) {
+			remove(atLeastOne(m, i));
+		}
+		for (unsigned j = 0; j + 1 < m; j++) {
+			for (unsigned k = 1; k < m; k++) {
+				for (unsigned i = 0; i < k; i++) {
+					remove(atMostOne(m, i, k, j));
+				}
+			}
+		}
+	}
+
+	void removeDefinitions(unsigned m) {
+		for (unsigned i = 0; i < m; i++) {
+			for (unsigned j = 0; j + 1 < m; j++) {
+				for (std::vector<int>& clause: definitions(m, i, j)) {
+					remove(clause);
+				}
+			}
+		}
+	}
+
+	void original(const std::vector<int>& clause) {
+		for (ProofSink* sink: sinks) {
+			sink->original(clause);
+		}
+	}
+
+	void lemma(const std::vector<int>& clause) {
+		for (ProofSink* sink: sinks) {
+			sink->lemma(clause);
+		}
+	}
+
+	void remove(const std::vector<int>& clause) {
+		for (ProofSink* sink: sinks) {
+			sink->remove(clause);
+		}
+	}
+};
@@ -0,0 +1,276 @@
+#include "EncodingCache.h"
+
+#include "PHPEncoder.h"
+#include "SolveMetrics.h"
+
+#include <cassert>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+namespace {
+	const KeyedFile::Format format = {
+		{'I', 'N', 'C', 'P', 'H', 'P', 'E', 'C'}, 2, ".enc", "encoding cache"
+	};
+
+	const std::int32_t mark = std::numeric_limits<std::int32_t>::min();
+	enum Kind: std::int32_t {
+		ASSUME = 1,
+		SOLVE = 2,
+		MAKESPAN = 3
+	};
+
+	auto& cacheResult() {
+		return SolveMetrics::current().result("encodingCache");
+	}
+
+	/**
+	 * Whether every mark of the stream has a known kind and its arguments,
+	 * checked before anything is passed to the solver.
+	 */
+	bool isValidStream(const std::int32_t* stream, std::size_t length) {
+		for (std::size_t i = 0; i < length; i++) {
+			if (stream[i] != mark) {
+				continue;
+			}
+			if (i + 1 >= length) {
+				return false;
+			}
+			switch (stream[i + 1]) {
+				case SOLVE:
+					i += 1;
+					break;
+				case ASSUME:
+				case MAKESPAN:
+					if (i + 2 >= length) {
+						return false;
+					}
+					i += 2;
+					break;
+				default:
+					return false;
+			}
+		}
+		return true;
+	}
+}
+
+/**
+ * Buffers the stream for the temporary file, which replaces the cache file
+ * on commit.
+ */
+class EncodingCache::Writer {
+public:
+	Writer(const KeyedFile& file):
+		writer(file)
+	{
+		buffer.reserve(bufferSize);
+	}
+
+	void push(std::int32_t value) {
+		buffer.push_back(value);
+		if (buffer.size() >= bufferSize) {
+			flush();
+		}
+	}
+
+	void pushMark(Kind kind) {
+		push(mark);
+		push(kind);
+	}
+
+	void commit() {
+		flush();
+		writer.commit();
+	}
+
+	std::size_t getNumBytes() {
+		return writer.getNumBytes();
+	}
+
+	unsigned numMakespans = 0;
+
+private:
+	static const std::size_t bufferSize = 1 << 16;
+
+	KeyedFile::Writer writer;
+	std::vector<std::int32_t> buffer;
+
+	void flush() {
+		writer.write(buffer.data(), buffer.size() * sizeof(std::int32_t));
+		buffer.clear();
+	}
+};
+
+namespace {
+	class RecordingDecorator: public ipasir::Ipasir {
+	public:
+		RecordingDecorator(
+			std::unique_ptr<Ipasir> _solver,
+			std::shared_ptr<EncodingCache::Writer> _writer):
+				solver(std::move(_solver)),
+				writer(_writer) {
+		}
+
+		virtual std::string signature() {
+			return solver->signature();
+		}
+
+		virtual void add(int lit_or_zero) {
+			writer->push(lit_or_zero);
+			solver->add(lit_or_zero);
+		}
+
+		virtual void assume(int lit) {
+			writer->pushMark(ASSUME);
+			writer->push(lit);
+			solver->assume(lit);
+		}
+
+		virtual ipasir::SolveResult solve() {
+			// the encoders start each makespan with a new entry in solves
+			auto& solves = SolveMetrics::current().solves();
+			if (solves.size() != writer->numMakespans && solves.size() > 0) {
+				writer->numMakespans = solves.size();
+				writer->pushMark(MAKESPAN);
+				writer->push(solves.back()["makespan"].get<int>());
+			}
+			writer->pushMark(SOLVE);
+			return solver->solve();
+		}
+
+		virtual int val(int lit) {
+			return solver->val(lit);
+		}
+
+		virtual int failed(int lit) {
+			return solver->failed(lit);
+		}
+
+		virtual void set_terminate(std::function<int(void)> callback) {
+			solver->set_terminate(callback);
+		}
+
+		virtual void set_learn(int max_length,
+				std::function<void(int*)> callback) {
+			solver->set_learn(max_length, callback);
+		}
+
+		virtual void set_learn_batch(int max_length,
+				std::function<void(int* begin, int* end)> callback) {
+			solver->set_learn_batch(max_length, callback);
+		}
+
+		virtual void set_select_literal(std::function<int(void)> callback) {
+			solver->set_select_literal(callback);
+		}
+
+		virtual void reset() {
+			solver->reset();
+		}
+
+	private:
+		std::unique_ptr<Ipasir> solver;
+		std::shared_ptr<EncodingCache::Writer> writer;
+	};
+}
+
+EncodingCache::EncodingCache(const std::string& directory,
+		const std::string& key):
+	file(directory, key, format)
+{
+}
+
+bool EncodingCache::replay(ipasir::Ipasir& solver) {
+	const std::string& path = file.getPath();
+	auto& result = cacheResult();
+	result["path"] = path;
+	result["hit"] = false;
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0
+			|| static_cast<std::size_t>(status.st_size) < file.headerSize()) {
+		close(fd);
+		return false;
+	}
+	std::size_t size = status.st_size;
+	void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+
+	const char* bytes = static_cast<const char*>(mapped);
+	std::size_t streamStart = file.headerSize();
+	bool valid = file.isValidHeader(bytes, size)
+		&& (size - streamStart) % sizeof(std::int32_t) == 0;
+
+	const std::int32_t* stream = reinterpret_cast<const std::int32_t*>(
+		bytes + streamStart);
+	std::size_t length = valid ?
+		(size - streamStart) / sizeof(std::int32_t) : 0;
+	madvise(mapped, size, MADV_SEQUENTIAL);
+	if (!valid || !isValidStream(stream, length)) {
+		LOG(WARNING) << "Ignoring invalid encoding cache '" << path << "'.";
+		munmap(mapped, size);
+		return false;
+	}
+
+	LOG(INFO) << "Replaying encoding from '" << path << "'.";
+	result["hit"] = true;
+	result["numBytes"] = size;
+
+	std::unique_ptr<CollectData::MakespanAndTime> makespan;
+	for (std::size_t i = 0; i < length; i++) {
+		if (stream[i] != mark) {
+			solver.add(stream[i]);
+			continue;
+		}
+		switch (stream[i + 1]) {
+			case ASSUME:
+				solver.assume(stream[i + 2]);
+				i += 2;
+				break;
+			case SOLVE: {
+				bool solved = (solver.solve() == ipasir::SolveResult::SAT);
+				assert(!solved);
+				i += 1;
+				break;
+			}
+			case MAKESPAN:
+				makespan.reset();
+				makespan = std::make_unique<CollectData::MakespanAndTime>(
+					stream[i + 2]);
+				i += 2;
+				break;
+		}
+	}
+	makespan.reset();
+
+	munmap(mapped, size);
+	return true;
+}
+
+std::unique_ptr<ipasir::Ipasir> EncodingCache::record(
+		std::unique_ptr<ipasir::Ipasir> solver) {
+	writer = std::make_shared<Writer>(file);
+	return std::make_unique<RecordingDecorator>(std::move(solver), writer);
+}
+
+void EncodingCache::commit() {
+	if (writer) {
+		writer->commit();
+		cacheResult()["numBytes"] = writer->getNumBytes();
+		writer.reset();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "KeyedFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Content addressed on disk cache of everything an encoder passes to the
+ * solver, so the encoding of a configuration is generated once and only
+ * replayed by later runs.
+ *
+ * A cache file is a KeyedFile with a stream of 32 bit integers in native
+ * byte order. Literals and zeros are clauses as given to add(), the
+ * smallest integer marks an assumption, a solve or the start of a makespan,
+ * followed by its argument. The file is mapped into memory, checked for
+ * complete marks and passed to the solver without parsing.
+ *
+ * Only the calls are cached, encoders which depend on the answers of the
+ * solver, i.e. on val() or failed(), must not be cached.
+ */
+class EncodingCache {
+public:
+	/**
+	 * @param key all parameters which determine the encoding
+	 */
+	EncodingCache(const std::string& directory, const std::string& key);
+
+	/**
+	 * Pass the cached stream to solver, returns false if there is no valid
+	 * cache file for the key.
+	 */
+	bool replay(ipasir::Ipasir& solver);
+
+	/**
+	 * Wrap solver in a decorator which records the stream for commit().
+	 */
+	std::unique_ptr<ipasir::Ipasir> record(
+		std::unique_ptr<ipasir::Ipasir> solver);
+
+	/**
+	 * Store the recorded stream under the key. Must only be called after
+	 * the encoder finished, an interrupted recording is discarded.
+	 */
+	void commit();
+
+	const std::string& getPath() {
+		return file.getPath();
+	}
+
+	class Writer;
+
+private:
+	KeyedFile file;
+	std::shared_ptr<Writer> writer;
+};
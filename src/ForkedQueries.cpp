@@ -0,0 +1,219 @@
+#include "ForkedQueries.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "carj/logging.h"
+
+namespace {
+	struct Record {
+		std::uint32_t query;
+		std::int32_t result;
+		double time;
+	};
+
+	// records are smaller than PIPE_BUF, so they are written atomically
+	bool writeRecord(int fd, const Record& record) {
+		ssize_t n;
+		do {
+			n = write(fd, &record, sizeof(record));
+		} while (n < 0 && errno == EINTR);
+		return n == sizeof(record);
+	}
+
+	bool readRecord(int fd, Record& record) {
+		char* buffer = reinterpret_cast<char*>(&record);
+		std::size_t done = 0;
+		while (done < sizeof(record)) {
+			ssize_t n = read(fd, buffer + done, sizeof(record) - done);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				return false;
+			}
+			done += n;
+		}
+		return true;
+	}
+
+	ForkedQuery timedSolve(unsigned query,
+			std::function<ipasir::SolveResult(unsigned query)>& solveQuery) {
+		ForkedQuery result;
+		auto start = std::chrono::steady_clock::now();
+		result.result = solveQuery(query);
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		result.time = elapsed.count();
+		return result;
+	}
+
+	[[noreturn]] void serve(int fd, unsigned worker, unsigned numQueries,
+			unsigned numWorkers,
+			std::function<ipasir::SolveResult(unsigned query)>& solveQuery) {
+		// the output of the solver would interleave with the one of the
+		// calling process
+		int devNull = open("/dev/null", O_WRONLY);
+		if (devNull >= 0) {
+			dup2(devNull, STDOUT_FILENO);
+			close(devNull);
+		}
+		el::Loggers::reconfigureAllLoggers(el::ConfigurationType::Enabled, "false");
+
+		for (unsigned query = worker; query < numQueries; query += numWorkers) {
+			ForkedQuery result = timedSolve(query, solveQuery);
+			Record record = {query, static_cast<std::int32_t>(result.result),
+				result.time};
+			if (!writeRecord(fd, record)) {
+				break;
+			}
+		}
+
+		// do not run destructors of the parent, i.e. writing carj.json
+		_exit(0);
+	}
+}
+
+std::vector<ForkedQuery> solveForked(
+		unsigned numQueries,
+		unsigned numWorkers,
+		std::function<ipasir::SolveResult(unsigned query)> solveQuery,
+		double timeout) {
+
+	if (numWorkers == 0) {
+		numWorkers = std::max(1u, std::thread::hardware_concurrency());
+	}
+	numWorkers = std::min(numWorkers, numQueries);
+
+	std::vector<ForkedQuery> results(numQueries);
+	std::vector<char> answered(numQueries, false);
+
+	std::vector<pid_t> pids;
+	std::vector<pollfd> fds;
+	if (numWorkers > 1) {
+		for (unsigned worker = 0; worker < numWorkers; worker++) {
+			int pipeFds[2];
+			if (pipe(pipeFds) != 0) {
+				LOG(WARNING) << "pipe failed: " << std::strerror(errno);
+				break;
+			}
+
+			pid_t pid = fork();
+			if (pid < 0) {
+				LOG(WARNING) << "fork failed: " << std::strerror(errno);
+				close(pipeFds[0]);
+				close(pipeFds[1]);
+				break;
+			}
+
+			if (pid == 0) {
+				close(pipeFds[0]);
+				for (pollfd& other: fds) {
+					close(other.fd);
+				}
+				serve(pipeFds[1], worker, numQueries, numWorkers, solveQuery);
+			}
+
+			close(pipeFds[1]);
+			pids.push_back(pid);
+			fds.push_back({pipeFds[0], POLLIN, 0});
+		}
+	}
+
+	typedef std::chrono::steady_clock Clock;
+	std::vector<Clock::time_point> lastAnswer(fds.size(), Clock::now());
+	auto stop = [&](unsigned worker, bool kill) {
+		if (kill) {
+			::kill(pids[worker], SIGKILL);
+		}
+		// poll ignores negative descriptors
+		close(fds[worker].fd);
+		fds[worker].fd = -1;
+	};
+
+	unsigned numOpen = fds.size();
+	while (numOpen > 0) {
+		int wait = -1;
+		if (timeout > 0) {
+			auto now = Clock::now();
+			for (unsigned worker = 0; worker < fds.size(); worker++) {
+				if (fds[worker].fd < 0) {
+					continue;
+				}
+				std::chrono::duration<double> left = lastAnswer[worker] - now
+					+ std::chrono::duration<double>(timeout);
+				int ms = std::max(0, static_cast<int>(left.count() * 1000) + 1);
+				wait = (wait < 0) ? ms : std::min(wait, ms);
+			}
+		}
+
+		int ready = poll(fds.data(), fds.size(), wait);
+		if (ready < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			LOG(FATAL) << "poll failed: " << std::strerror(errno);
+		}
+
+		auto now = Clock::now();
+		for (unsigned worker = 0; worker < fds.size(); worker++) {
+			pollfd& fd = fds[worker];
+			if (fd.fd < 0) {
+				continue;
+			}
+
+			if (fd.revents == 0) {
+				if (timeout > 0 && now - lastAnswer[worker]
+						> std::chrono::duration<double>(timeout)) {
+					LOG(WARNING) << "Query worker " << pids[worker]
+						<< " answered no query for " << timeout
+						<< " s and is killed.";
+					stop(worker, true);
+					numOpen -= 1;
+				}
+				continue;
+			}
+
+			Record record;
+			if (readRecord(fd.fd, record) && record.query < numQueries) {
+				ForkedQuery& result = results[record.query];
+				result.result = static_cast<ipasir::SolveResult>(record.result);
+				result.time = record.time;
+				result.worker = worker;
+				answered[record.query] = true;
+				lastAnswer[worker] = now;
+			} else {
+				// finished or crashed
+				stop(worker, false);
+				numOpen -= 1;
+			}
+		}
+	}
+
+	for (pid_t pid: pids) {
+		int status = 0;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			LOG(WARNING) << "Query worker " << pid << " failed, "
+				"its remaining queries are solved in this process.";
+		}
+	}
+
+	for (unsigned query = 0; query < numQueries; query++) {
+		if (!answered[query]) {
+			results[query] = timedSolve(query, solveQuery);
+		}
+	}
+
+	return results;
+}
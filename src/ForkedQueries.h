@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+
+#include <functional>
+#include <vector>
+
+struct ForkedQuery {
+	ipasir::SolveResult result = ipasir::SolveResult::TIMEOUT;
+	/**
+	 * Wall clock time of the solve in seconds.
+	 */
+	double time = 0;
+	/**
+	 * Index of the worker which answered the query, -1 if the calling
+	 * process solved it.
+	 */
+	int worker = -1;
+};
+
+/**
+ * Answers the queries [0, numQueries) with solveQuery in numWorkers forked
+ * processes, which start from the current state of the calling process. The
+ * solver is not copied, the workers share its memory copy on write.
+ * Worker i solves the queries i, i + numWorkers, ... and sends the results
+ * back through a pipe, the state of the calling process does not change.
+ * Queries of a worker which crashed, or which answered no query for timeout
+ * seconds and was killed, are solved by the calling process.
+ *
+ * Only the calling thread exists in the workers, so solveQuery must not
+ * wait for other threads and no other thread may hold a lock it takes.
+ * numWorkers 0 uses all cores, with one worker or one query no process is
+ * forked. timeout 0 waits for the workers without a limit.
+ */
+std::vector<ForkedQuery> solveForked(
+	unsigned numQueries,
+	unsigned numWorkers,
+	std::function<ipasir::SolveResult(unsigned query)> solveQuery,
+	double timeout = 0);
@@ -0,0 +1,541 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "PHPEncoder.h"
+#include "SatVariable.h"
+
+#include "carj/carj.h"
+#include "ipasir/ipasir_cpp.h"
+
+/**
+ * A family of unsatisfiable formulas, which grows in steps. The formula of
+ * each step is unsatisfiable and the clauses of later steps are added on
+ * top, so the steps are solved incrementally like the makespans of the pigeon
+ * hole encoders.
+ *
+ * Clauses which only hold for one step contain its activation literal,
+ * which is assumed to be false while solving the step.
+ */
+class InstanceFamily {
+public:
+	InstanceFamily(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numSteps):
+			solver(std::move(_solver)),
+			numSteps(std::max(1u, _numSteps)),
+			allocator(),
+			activationVar(allocator.newVariable(numSteps))
+	{
+	}
+
+	/**
+	 * Add the clauses of the given step, steps start at 1 and are added in
+	 * order.
+	 */
+	virtual void addStep(unsigned step) = 0;
+
+	virtual void encode() {
+		for (unsigned step = 1; step <= numSteps; step++) {
+			addStep(step);
+		}
+	}
+
+	virtual void solve(bool incremental) {
+		for (unsigned step = 1; step <= numSteps; step++) {
+			addStep(step);
+			if (incremental || step == numSteps) {
+				CollectData::MakespanAndTime m(step);
+				solver->assume(-activation(step));
+				bool solved = (solver->solve() == ipasir::SolveResult::SAT);
+				assert(!solved);
+			}
+		}
+		updateLoggedData();
+	}
+
+	unsigned getNumSteps() {
+		return numSteps;
+	}
+
+	unsigned numberOfVariables() {
+		return allocator.numberOfVariables();
+	}
+
+	virtual ~InstanceFamily() {
+	}
+
+protected:
+	std::unique_ptr<ipasir::Ipasir> solver;
+	unsigned numSteps;
+	SatVariableAllocator allocator;
+
+	int activation(unsigned step) {
+		return activationVar(step - 1);
+	}
+
+	/**
+	 * Add the clauses of the constraint that at most one of the literals is
+	 * true.
+	 */
+	void addAtMostOne(const std::vector<int>& literals) {
+		for (unsigned a = 1; a < literals.size(); a++) {
+			for (unsigned b = 0; b < a; b++) {
+				solver->addClause({-literals[a], -literals[b]});
+			}
+		}
+	}
+
+	/**
+	 * Uniform random number below bound. The generators of std are not
+	 * portable, so the instance would differ between standard libraries.
+	 */
+	static unsigned below(std::mt19937& random, unsigned bound) {
+		return random() % bound;
+	}
+
+private:
+	SatVariable<unsigned> activationVar;
+
+	void updateLoggedData() {
+		auto& family = SolveMetrics::current().result("family");
+		family["numSteps"] = numSteps;
+		family["numVariables"] = numberOfVariables();
+	}
+};
+
+/**
+ * Pigeon hole principle with numPigeons pigeons and one hole less on a
+ * bipartite graph, each pigeon may only go into its adjacent holes. Step h
+ * adds hole h - 1.
+ *
+ * Functional additionally forbids a pigeon to be in two holes and onto
+ * requires each hole to be used.
+ */
+class GraphPHP: public InstanceFamily {
+public:
+	/**
+	 * @param degree number of random holes adjacent to each pigeon, 0 for the
+	 *        complete graph
+	 */
+	GraphPHP(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numPigeons,
+		unsigned degree = 0,
+		bool _functional = false,
+		bool _onto = false):
+			InstanceFamily(std::move(_solver), std::max(2u, _numPigeons) - 1),
+			numPigeons(std::max(2u, _numPigeons)),
+			functional(_functional),
+			onto(_onto),
+			P(allocator.newVariable(numPigeons, numPigeons - 1)),
+			adjacent(numPigeons, std::vector<bool>(numPigeons - 1, false))
+	{
+		unsigned numHoles = numPigeons - 1;
+		std::mt19937 random(numPigeons);
+		for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+			std::vector<unsigned> holes(numHoles);
+			for (unsigned hole = 0; hole < numHoles; hole++) {
+				holes[hole] = hole;
+			}
+			unsigned numAdjacent = (degree == 0) ? numHoles
+				: std::min(degree, numHoles);
+			for (unsigned i = 0; i < numAdjacent; i++) {
+				std::swap(holes[i], holes[i + below(random, numHoles - i)]);
+				adjacent[pigeon][holes[i]] = true;
+			}
+		}
+	}
+
+	virtual void addStep(unsigned step) {
+		unsigned hole = step - 1;
+
+		std::vector<int> pigeons;
+		for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+			if (adjacent[pigeon][hole]) {
+				pigeons.push_back(P(pigeon, hole));
+			}
+		}
+		addAtMostOne(pigeons);
+
+		if (onto) {
+			solver->addClause(pigeons);
+		}
+
+		if (functional) {
+			for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+				if (!adjacent[pigeon][hole]) {
+					continue;
+				}
+				for (unsigned other = 0; other < hole; other++) {
+					if (adjacent[pigeon][other]) {
+						solver->addClause({-P(pigeon, other), -P(pigeon, hole)});
+					}
+				}
+			}
+		}
+
+		for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+			for (unsigned i = 0; i < step; i++) {
+				if (adjacent[pigeon][i]) {
+					solver->add(P(pigeon, i));
+				}
+			}
+			solver->add(activation(step));
+			solver->add(0);
+		}
+	}
+
+	virtual ~GraphPHP() {
+	}
+
+private:
+	unsigned numPigeons;
+	bool functional;
+	bool onto;
+	SatVariable<unsigned, unsigned> P;
+	std::vector<std::vector<bool>> adjacent;
+};
+
+/**
+ * Base for families on a graph, whose constraints are on the vertices and
+ * whose variables are the edges. Edges from a vertex of the current step to
+ * one which is not part of it yet are false in this step, so each step is
+ * the formula of the induced subgraph.
+ */
+class EdgeFamily: public InstanceFamily {
+public:
+	typedef std::vector<std::pair<unsigned, unsigned>> Edges;
+
+	EdgeFamily(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numSteps,
+		unsigned numVertices,
+		Edges _edges):
+			InstanceFamily(std::move(_solver), _numSteps),
+			edges(_edges),
+			incident(numVertices),
+			E(allocator.newVariable(std::max<unsigned>(1, edges.size())))
+	{
+		for (unsigned edge = 0; edge < edges.size(); edge++) {
+			incident[edges[edge].first].push_back(edge);
+			incident[edges[edge].second].push_back(edge);
+		}
+	}
+
+	virtual void addStep(unsigned step) {
+		for (unsigned vertex = 0; vertex < incident.size(); vertex++) {
+			if (isActive(vertex, step)
+					&& (step == 1 || !isActive(vertex, step - 1))) {
+				std::vector<int> literals;
+				for (unsigned edge: incident[vertex]) {
+					literals.push_back(E(edge));
+				}
+				addVertex(vertex, literals);
+			}
+		}
+
+		for (unsigned edge = 0; edge < edges.size(); edge++) {
+			if (isActive(edges[edge].first, step)
+					!= isActive(edges[edge].second, step)) {
+				solver->addClause({-E(edge), activation(step)});
+			}
+		}
+	}
+
+	virtual ~EdgeFamily() {
+	}
+
+protected:
+	/**
+	 * Add the constraints of vertex on the literals of its incident edges.
+	 */
+	virtual void addVertex(unsigned vertex, const std::vector<int>& literals) = 0;
+
+	/**
+	 * Whether vertex is part of the formula of step, a vertex stays part
+	 * of all later steps.
+	 */
+	virtual bool isActive(unsigned vertex, unsigned step) = 0;
+
+private:
+	Edges edges;
+	std::vector<std::vector<unsigned>> incident;
+	SatVariable<unsigned> E;
+};
+
+/**
+ * Tseitin formula on a random expander, which is a cycle with additional
+ * random perfect matchings. Step s adds vertex s - 1. The first vertex has
+ * odd charge, so the component which contains it is unsatisfiable in every
+ * step.
+ */
+class TseitinFamily: public EdgeFamily {
+public:
+	/**
+	 * @param degree degree of the vertices, 0 for 3
+	 */
+	TseitinFamily(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned numVertices,
+		unsigned degree = 0):
+			EdgeFamily(
+				std::move(_solver),
+				std::max(3u, numVertices),
+				std::max(3u, numVertices),
+				expander(std::max(3u, numVertices), degree))
+	{
+	}
+
+	virtual ~TseitinFamily() {
+	}
+
+protected:
+	virtual void addVertex(unsigned vertex, const std::vector<int>& literals) {
+		// forbid all assignments with the wrong parity
+		bool charge = (vertex == 0);
+		unsigned numLiterals = literals.size();
+		for (unsigned bits = 0; bits < (1u << numLiterals); bits++) {
+			bool parity = false;
+			std::vector<int> clause;
+			for (unsigned i = 0; i < numLiterals; i++) {
+				bool value = (bits >> i) & 1;
+				parity ^= value;
+				clause.push_back(value ? -literals[i] : literals[i]);
+			}
+			if (parity != charge) {
+				solver->addClause(clause);
+			}
+		}
+	}
+
+	virtual bool isActive(unsigned vertex, unsigned step) {
+		return vertex < step;
+	}
+
+private:
+	static Edges expander(unsigned n, unsigned degree) {
+		Edges edges;
+		std::set<std::pair<unsigned, unsigned>> added;
+		auto add = [&edges, &added](unsigned u, unsigned v) {
+			if (added.insert({std::min(u, v), std::max(u, v)}).second) {
+				edges.push_back({u, v});
+			}
+		};
+
+		for (unsigned v = 0; v < n; v++) {
+			add(v, (v + 1) % n);
+		}
+
+		// the degree is bounded, as each vertex constraint has
+		// 2^(degree - 1) clauses
+		degree = std::min(std::max(3u, degree), 10u);
+		std::mt19937 random(n);
+		for (unsigned i = 2; i < degree; i++) {
+			std::vector<unsigned> vertices(n);
+			for (unsigned v = 0; v < n; v++) {
+				vertices[v] = v;
+			}
+			for (unsigned v = 0; v + 1 < n; v++) {
+				std::swap(vertices[v], vertices[v + below(random, n - v)]);
+			}
+			for (unsigned v = 0; v + 1 < n; v += 2) {
+				add(vertices[v], vertices[v + 1]);
+			}
+		}
+		return edges;
+	}
+};
+
+/**
+ * Domino tiling of a 2n x 2n board without two opposite corners. Step s is
+ * the 2s x 2s board without the corners (0, 0) and (2s - 1, 2s - 1), the
+ * vertices are the cells and the edges are the dominos.
+ */
+class MutilatedChessboard: public EdgeFamily {
+public:
+	MutilatedChessboard(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned n):
+			EdgeFamily(
+				std::move(_solver),
+				std::max(1u, n),
+				4 * std::max(1u, n) * std::max(1u, n),
+				dominos(2 * std::max(1u, n))),
+			side(2 * std::max(1u, n))
+	{
+	}
+
+	virtual ~MutilatedChessboard() {
+	}
+
+protected:
+	virtual void addVertex(unsigned, const std::vector<int>& literals) {
+		solver->addClause(literals);
+		addAtMostOne(literals);
+	}
+
+	virtual bool isActive(unsigned vertex, unsigned step) {
+		unsigned row = vertex / side;
+		unsigned column = vertex % side;
+		unsigned boardSide = 2 * step;
+		return row < boardSide && column < boardSide
+			&& !(row == 0 && column == 0)
+			&& !(row == boardSide - 1 && column == boardSide - 1);
+	}
+
+private:
+	unsigned side;
+
+	static Edges dominos(unsigned side) {
+		Edges edges;
+		for (unsigned row = 0; row < side; row++) {
+			for (unsigned column = 0; column < side; column++) {
+				if (column + 1 < side) {
+					edges.push_back({row * side + column, row * side + column + 1});
+				}
+				if (row + 1 < side) {
+					edges.push_back({row * side + column, (row + 1) * side + column});
+				}
+			}
+		}
+		return edges;
+	}
+};
+
+/**
+ * The graph on numVertices vertices has a clique of size cliqueSize and is
+ * colorable with one color less. Step s adds vertex s - 1.
+ */
+class CliqueColoring: public InstanceFamily {
+public:
+	/**
+	 * @param cliqueSize 0 for half of the vertices
+	 */
+	CliqueColoring(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numVertices,
+		unsigned _cliqueSize = 0):
+			InstanceFamily(std::move(_solver), std::max(2u, _numVertices)),
+			numVertices(numSteps),
+			cliqueSize(std::min(numVertices, std::max(2u,
+				_cliqueSize == 0 ? numVertices / 2 : _cliqueSize))),
+			E(allocator.newVariable(numVertices, numVertices)),
+			Q(allocator.newVariable(cliqueSize, numVertices)),
+			R(allocator.newVariable(numVertices, cliqueSize - 1))
+	{
+	}
+
+	virtual void addStep(unsigned step) {
+		unsigned u = step - 1;
+		unsigned numColors = cliqueSize - 1;
+
+		std::vector<int> colors;
+		for (unsigned c = 0; c < numColors; c++) {
+			colors.push_back(R(u, c));
+		}
+		solver->addClause(colors);
+
+		for (unsigned v = 0; v < u; v++) {
+			for (unsigned c = 0; c < numColors; c++) {
+				solver->addClause({-E(v, u), -R(v, c), -R(u, c)});
+			}
+		}
+
+		std::vector<int> members;
+		for (unsigned i = 0; i < cliqueSize; i++) {
+			members.push_back(Q(i, u));
+		}
+		addAtMostOne(members);
+
+		for (unsigned v = 0; v < u; v++) {
+			for (unsigned i = 0; i < cliqueSize; i++) {
+				for (unsigned j = 0; j < cliqueSize; j++) {
+					if (i != j) {
+						solver->addClause({-Q(i, v), -Q(j, u), E(v, u)});
+					}
+				}
+			}
+		}
+
+		for (unsigned i = 0; i < cliqueSize; i++) {
+			for (unsigned v = 0; v < step; v++) {
+				solver->add(Q(i, v));
+			}
+			solver->add(activation(step));
+			solver->add(0);
+		}
+	}
+
+	virtual ~CliqueColoring() {
+	}
+
+private:
+	unsigned numVertices;
+	unsigned cliqueSize;
+	SatVariable<unsigned, unsigned> E;
+	SatVariable<unsigned, unsigned> Q;
+	SatVariable<unsigned, unsigned> R;
+};
+
+typedef std::function<std::unique_ptr<InstanceFamily>(
+		std::unique_ptr<ipasir::Ipasir> solver,
+		unsigned size,
+		unsigned parameter)>
+	InstanceFamilyFactory;
+
+/**
+ * All instance families by name. The size is the number of pigeons for the
+ * pigeon hole principles, the number of vertices for tseitin and
+ * cliqueColoring and half of the side of the board for mutilatedChessboard.
+ * The parameter is the degree of sparsePHP and tseitin and the clique size
+ * of cliqueColoring.
+ */
+inline const std::map<std::string, InstanceFamilyFactory>& instanceFamilies() {
+	static const std::map<std::string, InstanceFamilyFactory> families = {
+		{"php", [](std::unique_ptr<ipasir::Ipasir> solver, unsigned size,
+				unsigned) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<GraphPHP>(std::move(solver), size);
+		}},
+		{"sparsePHP", [](std::unique_ptr<ipasir::Ipasir> solver, unsigned size,
+				unsigned parameter) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<GraphPHP>(std::move(solver), size,
+				parameter == 0 ? 3 : parameter);
+		}},
+		{"functionalPHP", [](std::unique_ptr<ipasir::Ipasir> solver,
+				unsigned size, unsigned) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<GraphPHP>(std::move(solver), size, 0,
+				true);
+		}},
+		{"ontoPHP", [](std::unique_ptr<ipasir::Ipasir> solver, unsigned size,
+				unsigned) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<GraphPHP>(std::move(solver), size, 0,
+				true, true);
+		}},
+		{"mutilatedChessboard", [](std::unique_ptr<ipasir::Ipasir> solver,
+				unsigned size, unsigned) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<MutilatedChessboard>(std::move(solver),
+				size);
+		}},
+		{"tseitin", [](std::unique_ptr<ipasir::Ipasir> solver, unsigned size,
+				unsigned parameter) -> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<TseitinFamily>(std::move(solver), size,
+				parameter);
+		}},
+		{"cliqueColoring", [](std::unique_ptr<ipasir::Ipasir> solver,
+				unsigned size, unsigned parameter)
+				-> std::unique_ptr<InstanceFamily> {
+			return std::make_unique<CliqueColoring>(std::move(solver), size,
+				parameter);
+		}},
+	};
+	return families;
+}
@@ -0,0 +1,116 @@
+#include "KeyedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "carj/logging.h"
+
+namespace {
+	struct Header {
+		char magic[8];
+		std::uint32_t layoutVersion;
+		std::uint32_t keyLength;
+	};
+
+	std::size_t paddedLength(const std::string& key) {
+		return (key.size() + 3) / 4 * 4;
+	}
+
+	std::uint64_t fnv1a(const std::string& text) {
+		std::uint64_t hash = 14695981039346656037ull;
+		for (unsigned char c: text) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+KeyedFile::KeyedFile(const std::string& directory, const std::string& _key,
+		const Format& _format):
+	key(_key),
+	format(_format)
+{
+	if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+		LOG(WARNING) << "Could not create " << format.description
+			<< " directory '" << directory << "': " << std::strerror(errno);
+	}
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx",
+		static_cast<unsigned long long>(fnv1a(key)));
+	path = directory + "/" + name + format.extension;
+}
+
+std::size_t KeyedFile::headerSize() const {
+	return sizeof(Header) + paddedLength(key);
+}
+
+bool KeyedFile::isValidHeader(const char* data, std::size_t size) const {
+	if (size < headerSize()) {
+		return false;
+	}
+	Header header;
+	std::memcpy(&header, data, sizeof(header));
+	return std::memcmp(header.magic, format.magic, sizeof(header.magic)) == 0
+		&& header.layoutVersion == format.layoutVersion
+		&& header.keyLength == key.size()
+		&& key.compare(0, key.size(), data + sizeof(Header), key.size()) == 0;
+}
+
+KeyedFile::Writer::Writer(const KeyedFile& _keyedFile):
+	keyedFile(_keyedFile),
+	tmpPath(keyedFile.path + ".tmp" + std::to_string(getpid())),
+	file(std::fopen(tmpPath.c_str(), "wb")),
+	numBytes(0)
+{
+	if (file == nullptr) {
+		LOG(WARNING) << "Could not write " << keyedFile.format.description
+			<< " '" << tmpPath << "': " << std::strerror(errno);
+		return;
+	}
+
+	Header header;
+	std::memcpy(header.magic, keyedFile.format.magic, sizeof(header.magic));
+	header.layoutVersion = keyedFile.format.layoutVersion;
+	header.keyLength = keyedFile.key.size();
+	write(&header, sizeof(header));
+
+	std::vector<char> paddedKey(keyedFile.key.begin(), keyedFile.key.end());
+	paddedKey.resize(paddedLength(keyedFile.key), '\0');
+	write(paddedKey.data(), paddedKey.size());
+}
+
+KeyedFile::Writer::~Writer() {
+	if (file != nullptr) {
+		std::fclose(file);
+		std::remove(tmpPath.c_str());
+	}
+}
+
+void KeyedFile::Writer::write(const void* data, std::size_t size) {
+	if (file != nullptr) {
+		std::fwrite(data, 1, size, file);
+		numBytes += size;
+	}
+}
+
+bool KeyedFile::Writer::commit() {
+	if (file == nullptr) {
+		return false;
+	}
+	bool failed = std::ferror(file) != 0;
+	failed |= std::fclose(file) != 0;
+	file = nullptr;
+	if (failed || std::rename(tmpPath.c_str(),
+			keyedFile.path.c_str()) != 0) {
+		LOG(WARNING) << "Could not write " << keyedFile.format.description
+			<< " '" << keyedFile.path << "'.";
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * A file of an on disk store which is named by the hash of a key, i.e. all
+ * parameters of an encoding. It starts with a header of the magic of the
+ * store, the version of its layout and the key itself, padded to a multiple
+ * of four bytes, so a file of another key under the same name is rejected.
+ * The content of the store follows the header.
+ *
+ * Used by EncodingCache and LemmaStore.
+ */
+class KeyedFile {
+public:
+	struct Format {
+		char magic[8];
+		std::uint32_t layoutVersion;
+		const char* extension;
+		// for log messages, i.e. "encoding cache"
+		const char* description;
+	};
+
+	/**
+	 * Creates the directory if it does not exist.
+	 */
+	KeyedFile(const std::string& directory, const std::string& key,
+		const Format& format);
+
+	const std::string& getPath() const {
+		return path;
+	}
+
+	/**
+	 * Size of the header, which is where the content starts.
+	 */
+	std::size_t headerSize() const;
+
+	/**
+	 * Whether data of at least size bytes starts with the header of this
+	 * file.
+	 */
+	bool isValidHeader(const char* data, std::size_t size) const;
+
+	class Writer;
+
+private:
+	std::string key;
+	Format format;
+	std::string path;
+};
+
+/**
+ * Writes the header and the content to a temporary file, which replaces
+ * the file on commit, so readers never see a partial file. The temporary
+ * file of a writer which is not committed is removed.
+ */
+class KeyedFile::Writer {
+public:
+	Writer(const KeyedFile& file);
+	~Writer();
+
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+
+	void write(const void* data, std::size_t size);
+
+	/**
+	 * Returns false and logs a warning if the file could not be written.
+	 */
+	bool commit();
+
+	std::size_t getNumBytes() const {
+		return numBytes;
+	}
+
+private:
+	KeyedFile keyedFile;
+	std::string tmpPath;
+	std::FILE* file;
+	std::size_t numBytes;
+};
@@ -1,18 +1,30 @@
+#pragma once
+
 #include "ipasir/ipasir_cpp.h"
+#include "SolveMetrics.h"
 #include "carj/carj.h"
 #include "carj/logging.h"
 
+#include <functional>
 #include <iostream>
-
-class LearnedClauseEvaluationDecorator: public ipasir::Ipasir {
+#include <memory>
+#include <set>
+
+/**
+ * Next is either std::unique_ptr<Ipasir> or a solver type which is held by
+ * value and constructed from the constructor arguments.
+ */
+template<class Next>
+class BasicLearnedClauseEvaluationDecorator: public ipasir::Ipasir {
 public:
 
-	LearnedClauseEvaluationDecorator(std::unique_ptr<Ipasir> _solver = std::make_unique<ipasir::Solver>()):
-			solver(std::move(_solver)) {
+	template<class ... Args>
+	BasicLearnedClauseEvaluationDecorator(Args&& ... args):
+			solver(std::forward<Args>(args)...) {
 		init();
 	}
 
-	virtual ~LearnedClauseEvaluationDecorator(){
+	virtual ~BasicLearnedClauseEvaluationDecorator(){
 		LOG(INFO) << numLearnedClausesWithAssumedLiteral;
 		LOG(INFO) << numLearnedClauses;
 		LOG(INFO) << numSolvesWithAssumptionFound;
@@ -29,25 +41,25 @@ public:
 	}
 
 	virtual std::string signature(){
-		return solver->signature();
+		return ipasir::layer(solver).signature();
 	};
 
 	virtual void add(int lit_or_zero) {
-		solver->add(lit_or_zero);
+		ipasir::layer(solver).add(lit_or_zero);
 	}
 
 	virtual void assume(int lit) {
-		solver->assume(lit);
+		ipasir::layer(solver).assume(lit);
 		// std::cout << lit << " ";
 		assumedClause.insert(-lit);
 	}
 
 	virtual int val(int lit) {
-		return solver->val(lit);
+		return ipasir::layer(solver).val(lit);
 	};
 
 	virtual int failed (int lit) {
-		return solver->failed(lit);
+		return ipasir::layer(solver).failed(lit);
 	};
 
 	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
@@ -59,7 +71,7 @@ public:
 		// std::cout << std::endl << "learned:" << std::endl;
 		this->foundAssumed = false;
 		this->foundSubsetAssumed = false;
-		auto result = solver->solve();
+		auto result = ipasir::layer(solver).solve();
 		if (this->assumedClause.size() > 0) {
 			this->numSolvesWithAssumption += 1;
 			if (this->foundAssumed) {
@@ -76,11 +88,15 @@ public:
 	}
 
 	virtual void set_terminate (std::function<int(void)> callback) {
-		solver->set_terminate(callback);
+		ipasir::layer(solver).set_terminate(callback);
 	};
 
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		ipasir::layer(solver).set_select_literal(callback);
+	}
+
 	virtual void reset() {
-		solver->reset();
+		ipasir::layer(solver).reset();
 		init();
 	};
 
@@ -95,12 +111,12 @@ public:
 		numSolvesWithAssumptionFound = 0;
 		numSolvesWithSubsetAssumptionFound = 0;
 
-		solver->set_learn(
-			10000,
-			std::bind(
-				&LearnedClauseEvaluationDecorator::learnedClauseEval,
-				this,
-				std::placeholders::_1));
+		ipasir::layer(solver).set_learn_batch(10000,
+			[this](int* begin, int* end) {
+				ipasir::forEachClause(begin, end, [this](int* learned) {
+					learnedClauseEval(learned);
+				});
+			});
 	}
 
 	virtual void learnedClauseEval(int* learned) {
@@ -132,7 +148,7 @@ public:
 	}
 
 private:
-	std::unique_ptr<Ipasir> solver;
+	Next solver;
 	std::set<int> assumedClause;
 	int max_length;
 	std::function<void(int*)> learnedClauseCallback;
@@ -147,8 +163,7 @@ private:
 	unsigned numSolvesWithSubsetAssumptionFound;
 
 	void updateLoggedData(){
-		static auto& solves = carj::getCarj()
-			.data["/incphp/result/solves"_json_pointer];
+		auto& solves = SolveMetrics::current().solves();
 
 		if (solves.size() > 0) {
 			solves.back()["numLearnedClauses"] = numLearnedClauses;
@@ -158,8 +173,7 @@ private:
 			solves.back()["numSolvesWithSubsetAssumptionFound"] = numSolvesWithSubsetAssumptionFound;
 		}
 
-		static auto& global = carj::getCarj()
-			.data["/incphp/result/learnedClauseEval"_json_pointer];
+		auto& global = SolveMetrics::current().result("learnedClauseEval");
 		global["numLearnedClauses"] = numLearnedClauses;
 		global["numLearnedClausesWithAssumedLiteral"] = numLearnedClausesWithAssumedLiteral;
 		global["numSolvesWithAssumption"] = numSolvesWithAssumption;
@@ -167,3 +181,6 @@ private:
 		global["numSolvesWithSubsetAssumptionFound"] = numSolvesWithSubsetAssumptionFound;
 	}
 };
+
+typedef BasicLearnedClauseEvaluationDecorator<std::unique_ptr<ipasir::Ipasir>>
+	LearnedClauseEvaluationDecorator;
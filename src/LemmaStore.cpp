@@ -0,0 +1,199 @@
+#include "LemmaStore.h"
+#include "SolveMetrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "carj/carj.h"
+#include "carj/ScopedTimer.h"
+#include "carj/logging.h"
+
+namespace {
+	const KeyedFile::Format format = {
+		{'I', 'N', 'C', 'P', 'H', 'P', 'L', 'S'}, 2, ".lemmas", "lemma store"
+	};
+
+	auto& storeResult() {
+		return SolveMetrics::current().result("lemmaStore");
+	}
+
+	class CollectingDecorator: public ipasir::Ipasir {
+	public:
+		CollectingDecorator(
+			std::unique_ptr<Ipasir> _solver,
+			std::shared_ptr<LemmaStore::Lemmas> _lemmas,
+			unsigned _storeLength):
+				solver(std::move(_solver)),
+				lemmas(_lemmas),
+				storeLength(_storeLength),
+				maxVariable(0),
+				maxLength(0),
+				learnCallback([](int*){}) {
+			setLearn();
+		}
+
+		virtual std::string signature() {
+			return solver->signature();
+		}
+
+		virtual void add(int lit_or_zero) {
+			maxVariable = std::max(maxVariable, std::abs(lit_or_zero));
+			solver->add(lit_or_zero);
+		}
+
+		virtual void assume(int lit) {
+			solver->assume(lit);
+		}
+
+		virtual ipasir::SolveResult solve() {
+			return solver->solve();
+		}
+
+		virtual int val(int lit) {
+			return solver->val(lit);
+		}
+
+		virtual int failed(int lit) {
+			return solver->failed(lit);
+		}
+
+		virtual void set_terminate(std::function<int(void)> callback) {
+			solver->set_terminate(callback);
+		}
+
+		virtual void set_learn(int max_length,
+				std::function<void(int*)> callback) {
+			maxLength = max_length;
+			learnCallback = callback;
+			setLearn();
+		}
+
+		virtual void set_select_literal(std::function<int(void)> callback) {
+			solver->set_select_literal(callback);
+		}
+
+		virtual void reset() {
+			solver->reset();
+			maxVariable = 0;
+			setLearn();
+		}
+
+	private:
+		std::unique_ptr<Ipasir> solver;
+		std::shared_ptr<LemmaStore::Lemmas> lemmas;
+		int storeLength;
+		int maxVariable;
+
+		int maxLength;
+		std::function<void(int*)> learnCallback;
+
+		void setLearn() {
+			solver->set_learn(std::max(storeLength, maxLength),
+				[this](int* learned) {
+					int length = 0;
+					bool known = true;
+					for (; learned[length] != 0; length++) {
+						known &= std::abs(learned[length]) <= maxVariable;
+					}
+					if (length <= storeLength && known) {
+						std::vector<int> lemma(learned, learned + length);
+						std::sort(lemma.begin(), lemma.end());
+						lemmas->insert(std::move(lemma));
+					}
+					if (length <= maxLength) {
+						learnCallback(learned);
+					}
+				});
+		}
+	};
+}
+
+LemmaStore::LemmaStore(const std::string& directory, const std::string& key,
+		unsigned _maxLength):
+	file(directory, key, format),
+	maxLength(_maxLength),
+	lemmas(std::make_shared<Lemmas>()),
+	numLoaded(0)
+{
+}
+
+std::size_t LemmaStore::load(ipasir::Ipasir& solver) {
+	const std::string& path = file.getPath();
+	auto& result = storeResult();
+	result["path"] = path;
+	carj::ScopedTimer timer(result["loadTime"]);
+
+	std::FILE* in = std::fopen(path.c_str(), "rb");
+	if (in == nullptr) {
+		result["numLoaded"] = 0;
+		return 0;
+	}
+
+	std::vector<char> header(file.headerSize());
+	if (std::fread(header.data(), 1, header.size(), in) != header.size()
+			|| !file.isValidHeader(header.data(), header.size())) {
+		LOG(WARNING) << "Ignoring invalid lemma store '" << path << "'.";
+		std::fclose(in);
+		result["numLoaded"] = 0;
+		return 0;
+	}
+
+	std::vector<std::int32_t> stream;
+	std::int32_t buffer[1 << 12];
+	std::size_t numRead;
+	while ((numRead = std::fread(buffer, sizeof(std::int32_t),
+			sizeof(buffer) / sizeof(std::int32_t), in)) > 0) {
+		stream.insert(stream.end(), buffer, buffer + numRead);
+	}
+	std::fclose(in);
+
+	std::vector<int> lemma;
+	for (std::int32_t lit: stream) {
+		solver.add(lit);
+		if (lit != 0) {
+			lemma.push_back(lit);
+		} else {
+			lemmas->insert(lemma);
+			lemma.clear();
+		}
+	}
+	// a truncated last lemma is not terminated
+	if (!lemma.empty()) {
+		solver.add(0);
+		lemmas->insert(lemma);
+	}
+
+	numLoaded = lemmas->size();
+	result["numLoaded"] = numLoaded;
+	result["numBytes"] = header.size() + stream.size() * sizeof(std::int32_t);
+	LOG(INFO) << "Loaded " << numLoaded << " lemmas from '" << path << "'.";
+	return numLoaded;
+}
+
+std::unique_ptr<ipasir::Ipasir> LemmaStore::collect(
+		std::unique_ptr<ipasir::Ipasir> solver) {
+	return std::make_unique<CollectingDecorator>(
+		std::move(solver), lemmas, maxLength);
+}
+
+void LemmaStore::save() {
+	auto& result = storeResult();
+	carj::ScopedTimer timer(result["saveTime"]);
+
+	KeyedFile::Writer writer(file);
+	std::vector<std::int32_t> stream;
+	for (const std::vector<int>& lemma: *lemmas) {
+		stream.insert(stream.end(), lemma.begin(), lemma.end());
+		stream.push_back(0);
+	}
+	writer.write(stream.data(), stream.size() * sizeof(std::int32_t));
+	if (!writer.commit()) {
+		return;
+	}
+
+	result["numLearned"] = lemmas->size() - numLoaded;
+	result["numSaved"] = lemmas->size();
+	LOG(INFO) << "Saved " << lemmas->size() << " lemmas, "
+		<< lemmas->size() - numLoaded << " new.";
+}
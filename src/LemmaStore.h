@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "KeyedFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * On disk store of short learned clauses, so later runs of the same
+ * encoding start with the lemmas of earlier runs instead of learning them
+ * again.
+ *
+ * A store file is a KeyedFile with the clauses as zero terminated 32 bit
+ * literals in native byte order. Each save writes the loaded and the
+ * newly learned lemmas, so the store grows over the runs.
+ *
+ * Learned clauses are implied by the formula the solver had at that time,
+ * so the lemmas are implied by the complete encoding. Loaded at the start,
+ * they are also known to the earlier makespans of an incremental run.
+ */
+class LemmaStore {
+public:
+	typedef std::set<std::vector<int>> Lemmas;
+
+	/**
+	 * @param key all parameters which determine the encoding
+	 * @param maxLength only learned clauses up to this length are stored
+	 */
+	LemmaStore(const std::string& directory, const std::string& key,
+		unsigned maxLength);
+
+	/**
+	 * Add the stored lemmas to solver and return their number.
+	 */
+	std::size_t load(ipasir::Ipasir& solver);
+
+	/**
+	 * Wrap solver in a decorator which collects the learned clauses over
+	 * the variables passed to add().
+	 */
+	std::unique_ptr<ipasir::Ipasir> collect(
+		std::unique_ptr<ipasir::Ipasir> solver);
+
+	/**
+	 * Write the loaded and the collected lemmas under the key.
+	 */
+	void save();
+
+	const std::string& getPath() {
+		return file.getPath();
+	}
+
+private:
+	KeyedFile file;
+	unsigned maxLength;
+	std::shared_ptr<Lemmas> lemmas;
+	std::size_t numLoaded;
+};
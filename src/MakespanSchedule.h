@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+
+/**
+ * Decides which makespans of an incremental encoder are solved, as the step
+ * schedules of incremental planners. The encoder adds all holes up to the
+ * makespan returned by next, solves and reports the result. Each schedule
+ * stops after the first satisfiable makespan and, if there is none, ends
+ * with the largest makespan.
+ *  - linear: 1, 2, 3, ...
+ *  - exponential: 1, 2, 4, 8, ...
+ *  - skip: stride, 2 * stride, 3 * stride, ...
+ *  - binary: binary search for the first satisfiable makespan
+ *
+ * A makespan may be smaller than an earlier one in binary search, the
+ * encoders only assume the goal of the makespan, so the holes added for
+ * larger makespans do not matter.
+ */
+class MakespanSchedule {
+public:
+	enum class Kind {
+		LINEAR,
+		EXPONENTIAL,
+		SKIP,
+		BINARY
+	};
+
+	MakespanSchedule(Kind _kind = Kind::LINEAR, unsigned _stride = 1):
+		kind(_kind),
+		stride(std::max(1u, _stride)),
+		maxMakespan(0),
+		lower(0),
+		upper(0),
+		current(0),
+		done(false)
+	{
+	}
+
+	/**
+	 * Returns false for an unknown name.
+	 */
+	static bool fromName(const std::string& name, unsigned stride,
+			MakespanSchedule& schedule) {
+		if (name == "linear") {
+			schedule = MakespanSchedule(Kind::LINEAR, stride);
+		} else if (name == "exponential") {
+			schedule = MakespanSchedule(Kind::EXPONENTIAL, stride);
+		} else if (name == "skip") {
+			schedule = MakespanSchedule(Kind::SKIP, stride);
+		} else if (name == "binary") {
+			schedule = MakespanSchedule(Kind::BINARY, stride);
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Start a schedule over the makespans 1 to _maxMakespan.
+	 */
+	void start(unsigned _maxMakespan) {
+		maxMakespan = _maxMakespan;
+		lower = 1;
+		upper = maxMakespan;
+		current = 0;
+		done = (maxMakespan == 0);
+	}
+
+	/**
+	 * The next makespan to solve, 0 if the schedule is done.
+	 */
+	unsigned next() {
+		if (done) {
+			return 0;
+		}
+
+		switch (kind) {
+			case Kind::LINEAR:
+				current += 1;
+				break;
+			case Kind::EXPONENTIAL:
+				current = (current == 0) ? 1 : 2 * current;
+				break;
+			case Kind::SKIP:
+				current += stride;
+				break;
+			case Kind::BINARY:
+				current = lower + (upper - lower) / 2;
+				return current;
+		}
+		current = std::min(current, maxMakespan);
+		return current;
+	}
+
+	/**
+	 * Result of solving the makespan returned by the last call of next.
+	 */
+	void report(bool satisfiable) {
+		if (kind == Kind::BINARY) {
+			if (satisfiable) {
+				upper = current - 1;
+			} else {
+				lower = current + 1;
+			}
+			done = (lower > upper);
+		} else {
+			done = satisfiable || current == maxMakespan;
+		}
+	}
+
+	std::string name() const {
+		switch (kind) {
+			case Kind::LINEAR:
+				return "linear";
+			case Kind::EXPONENTIAL:
+				return "exponential";
+			case Kind::SKIP:
+				return "skip";
+			case Kind::BINARY:
+				return "binary";
+		}
+		return "";
+	}
+
+	unsigned getStride() const {
+		return stride;
+	}
+
+private:
+	Kind kind;
+	unsigned stride;
+	unsigned maxMakespan;
+	unsigned lower;
+	unsigned upper;
+	unsigned current;
+	bool done;
+};
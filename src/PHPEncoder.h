@@ -0,0 +1,1005 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DecisionOrder.h"
+#include "ForkedQueries.h"
+#include "MakespanSchedule.h"
+#include "ProgressExporter.h"
+#include "SolveMetrics.h"
+#include "ParallelClauses.h"
+#include "VariableContainer.h"
+#include "SubsetIndex.h"
+
+#include "tclap/CmdLine.h"
+#include "carj/carj.h"
+#include "carj/ScopedTimer.h"
+#include "ipasir/ipasir_cpp.h"
+
+#include "carj/logging.h"
+
+extern carj::CarjArg<TCLAP::SwitchArg, bool> addAssumed;
+extern carj::CarjArg<TCLAP::SwitchArg, bool> fixedUpperBound;
+extern carj::CarjArg<TCLAP::SwitchArg, bool> coreReuse;
+extern carj::CarjArg<TCLAP::SwitchArg, bool> lazyAtMostOne;
+extern carj::TCarjArg<TCLAP::ValueArg, std::string> variableLayout;
+
+/**
+ * Version of what the encoders pass to the solver, part of the keys of
+ * cached encodings and stored lemmas. Bump it with every change of the
+ * clauses, the variable numbering or the order of the calls.
+ */
+const unsigned encoderVersion = 2;
+
+/**
+ * The layout of the variables of the encoders.
+ */
+inline VariableLayout selectedVariableLayout() {
+	VariableLayout layout = VariableLayout::PIGEON_MAJOR;
+	if (!variableLayoutFromName(variableLayout.getValue(), layout)) {
+		LOG(FATAL) << "Unknown variable layout '"
+			<< variableLayout.getValue() << "'.";
+	}
+	return layout;
+}
+
+namespace CollectData {
+class MakespanAndTime {
+public:
+	MakespanAndTime(unsigned makespan) {
+		auto& solves = SolveMetrics::current().solves();
+		solves.emplace_back();
+		solves.back()["makespan"] = makespan;
+		LOG(INFO) << "makespan: " << makespan;
+		progressCounters().makespan = makespan;
+
+		timer = std::make_unique<carj::ScopedTimer>(solves.back()["time"]);
+	}
+private:
+	std::unique_ptr<carj::ScopedTimer> timer;
+};
+}
+
+class UniversalPHPEncoder {
+public:
+	UniversalPHPEncoder(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numPigeons):
+
+		UniversalPHPEncoder(
+			std::move(_solver),
+			std::make_unique<BasicVariableContainer>(
+				_numPigeons, selectedVariableLayout()),
+			_numPigeons
+		)
+	{}
+
+	UniversalPHPEncoder(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		std::unique_ptr<VariableContainer> _var,
+		unsigned _numPigeons):
+			solver(std::move(_solver)),
+			var(std::move(_var)),
+			numPigeons(_numPigeons)
+	{
+		assert(numPigeons > 1);
+	}
+
+	virtual void addAtMostOnePigeonInHole(unsigned hole) {
+		if (lazyAtMostOne.getValue()) {
+			lazyHoles.push_back(hole);
+			return;
+		}
+
+		atMostOnePigeonInHole(hole, *solver);
+	}
+
+	virtual void addAtLeastOneHolePerPigeon(
+			unsigned numHoles,
+			unsigned activationLiteral = 0) {
+
+		for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+			for (unsigned hole = 0; hole < numHoles; hole++) {
+				solver->add(var->pigeonInHole(pigeon, hole));
+			}
+			if (activationLiteral != 0) {
+				solver->add(activationLiteral);
+			}
+			solver->add(0);
+		}
+	}
+
+	virtual void solve(){
+		encode();
+		bool solved = (solveAssumed() == ipasir::SolveResult::SAT);
+		assert(!solved);
+	}
+
+	/**
+	 * Add the complete formula for numPigeons - 1 holes without solving it.
+	 */
+	virtual void encode() {
+		unsigned numHoles = numPigeons - 1;
+
+		addAtLeastOneHolePerPigeon(numHoles);
+		if (lazyAtMostOne.getValue()) {
+			for (unsigned hole = 0; hole < numHoles; hole++) {
+				addAtMostOnePigeonInHole(hole);
+			}
+		} else {
+			generateClauses(*solver, numHoles, numEncodeThreads,
+				[this](unsigned hole, auto& out) {
+					atMostOnePigeonInHole(hole, out);
+				});
+		}
+	}
+
+	/**
+	 * Assumptions which are needed to make the formula added by encode()
+	 * unsatisfiable.
+	 */
+	virtual std::vector<int> goalAssumptions() {
+		return {};
+	}
+
+	/**
+	 * Solve the formula added by encode() under the goal assumptions and
+	 * the given cube. Nothing is logged, so workers of different threads
+	 * can call this.
+	 */
+	virtual ipasir::SolveResult solveCube(const std::vector<int>& cube) {
+		for (int lit: goalAssumptions()) {
+			assume(lit);
+		}
+		for (int lit: cube) {
+			assume(lit);
+		}
+		return solveAssumed(false);
+	}
+
+	virtual void setTerminate(std::function<int(void)> callback) {
+		solver->set_terminate(callback);
+	}
+
+	/**
+	 * Decision literals for the given heuristic, empty if the encoder does
+	 * not know it.
+	 *  - holeMajor: place pigeons into the first hole, then the second, ...
+	 *  - pigeonMajor: place the first pigeon, then the second, ...
+	 */
+	virtual std::vector<int> decisionOrder(const std::string& heuristic) {
+		std::vector<int> order;
+		unsigned numHoles = numPigeons - 1;
+		if (heuristic == "holeMajor") {
+			for (unsigned hole = 0; hole < numHoles; hole++) {
+				for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+					order.push_back(var->pigeonInHole(pigeon, hole));
+				}
+			}
+		} else if (heuristic == "pigeonMajor") {
+			for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+				for (unsigned hole = 0; hole < numHoles; hole++) {
+					order.push_back(var->pigeonInHole(pigeon, hole));
+				}
+			}
+		}
+		return order;
+	}
+
+	/**
+	 * Let the solver branch in the order of the given heuristic. Returns
+	 * false if the encoder does not know it.
+	 */
+	bool useDecisionOrder(const std::string& heuristic) {
+		std::vector<int> order = decisionOrder(heuristic);
+		if (order.empty()) {
+			return false;
+		}
+		decisions = std::make_unique<DecisionOrder>(std::move(order));
+		DecisionOrder* current = decisions.get();
+		solver->set_select_literal([current]() {
+			return current->select();
+		});
+		return true;
+	}
+
+	virtual VariableContainer* getVar() {
+		return var.get();
+	}
+
+	/**
+	 * Number of threads which generate the large blocks of clauses in
+	 * encode(), 0 uses all cores. The formula does not depend on it.
+	 */
+	void setEncodeThreads(unsigned numThreads) {
+		numEncodeThreads = numThreads;
+	}
+
+	/**
+	 * Which makespans the incremental solve methods solve.
+	 */
+	void setSchedule(MakespanSchedule _schedule) {
+		schedule = _schedule;
+	}
+
+	virtual ~UniversalPHPEncoder(){
+
+	}
+
+protected:
+	std::unique_ptr<ipasir::Ipasir> solver;
+	std::unique_ptr<VariableContainer> var;
+	unsigned numPigeons;
+	unsigned numEncodeThreads = 1;
+	MakespanSchedule schedule;
+
+	template<class Sink>
+	void atMostOnePigeonInHole(unsigned hole, Sink& out) {
+		for (unsigned pigeonA = 1; pigeonA < numPigeons; pigeonA++) {
+			for (unsigned pigeonB = 0; pigeonB < pigeonA; pigeonB++) {
+				out.addClause({
+					-var->pigeonInHole(pigeonA, hole),
+					-var->pigeonInHole(pigeonB, hole)
+				});
+			}
+		}
+	}
+
+	/**
+	 * Solve the makespans of the schedule. Before a makespan is solved, the
+	 * clauses of all hole counts up to it are added by addHoles, also of
+	 * those which are skipped. solveHoles returns true if the makespan is
+	 * satisfiable.
+	 */
+	void solveScheduled(
+			std::function<void(unsigned numHoles)> addHoles,
+			std::function<bool(unsigned numHoles)> solveHoles) {
+		unsigned numEncoded = 0;
+		unsigned numSolved = 0;
+		schedule.start(numPigeons - 1);
+		for (unsigned numHoles = schedule.next(); numHoles != 0;
+				numHoles = schedule.next()) {
+			for (; numEncoded < numHoles; numEncoded++) {
+				addHoles(numEncoded + 1);
+			}
+
+			bool solved;
+			{
+				CollectData::MakespanAndTime m(numHoles);
+				solved = solveHoles(numHoles);
+			}
+			schedule.report(solved);
+			numSolved += 1;
+		}
+		updateScheduleLoggedData(numEncoded, numSolved);
+	}
+
+	void assume(int lit) {
+		assumptions.push_back(lit);
+		solver->assume(lit);
+	}
+
+	/**
+	 * Solve under the literals passed to assume() since the last solve.
+	 *
+	 * With lazyAtMostOne the at most one clauses of a hole are only added
+	 * once a model places two pigeons in it, and the solve is repeated
+	 * until the result is not SAT or the model violates no at most one
+	 * clause.
+	 */
+	ipasir::SolveResult solveAssumed(bool log = true) {
+		if (decisions) {
+			decisions->rewind();
+		}
+		ipasir::SolveResult result = solver->solve();
+		if (lazyAtMostOne.getValue()) {
+			unsigned numRounds = 0;
+			while (result == ipasir::SolveResult::SAT && refine()) {
+				for (int lit: assumptions) {
+					solver->assume(lit);
+				}
+				if (decisions) {
+					decisions->rewind();
+				}
+				result = solver->solve();
+				numRounds += 1;
+			}
+			if (log && numRounds > 0) {
+				updateLazyLoggedData();
+			}
+		}
+		if (log && decisions) {
+			updateDecisionLoggedData();
+		}
+		assumptions.clear();
+		return result;
+	}
+
+private:
+	std::unique_ptr<DecisionOrder> decisions;
+	std::vector<int> assumptions;
+	std::vector<unsigned> lazyHoles;
+	unsigned numRefinements = 0;
+	unsigned numMaterialized = 0;
+
+	/**
+	 * Add at most one clauses violated by the current model. Returns false
+	 * if there are none.
+	 *
+	 * Models of the at least one clauses tend to put pigeons in many holes,
+	 * so only the first hole of each pigeon is considered at first. Only if
+	 * this placement is free of conflicts, all violated clauses are added.
+	 */
+	bool refine() {
+		std::vector<int> placed(numPigeons, -1);
+		std::vector<std::vector<unsigned>> pigeons(lazyHoles.size());
+		for (unsigned i = 0; i < lazyHoles.size(); i++) {
+			for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
+				if (solver->val(var->pigeonInHole(pigeon, lazyHoles[i])) > 0) {
+					pigeons[i].push_back(pigeon);
+					if (placed[pigeon] < 0) {
+						placed[pigeon] = i;
+					}
+				}
+			}
+		}
+
+		unsigned numAdded = 0;
+		for (unsigned i = 0; i < lazyHoles.size(); i++) {
+			std::vector<unsigned> first;
+			for (unsigned pigeon: pigeons[i]) {
+				if (placed[pigeon] == static_cast<int>(i)) {
+					first.push_back(pigeon);
+				}
+			}
+			numAdded += addAtMostOne(lazyHoles[i], first);
+		}
+		if (numAdded == 0) {
+			for (unsigned i = 0; i < lazyHoles.size(); i++) {
+				numAdded += addAtMostOne(lazyHoles[i], pigeons[i]);
+			}
+		}
+
+		if (numAdded > 0) {
+			numRefinements += 1;
+			numMaterialized += numAdded;
+		}
+		return numAdded > 0;
+	}
+
+	unsigned addAtMostOne(unsigned hole, const std::vector<unsigned>& pigeons) {
+		unsigned numAdded = 0;
+		for (unsigned a = 1; a < pigeons.size(); a++) {
+			for (unsigned b = 0; b < a; b++) {
+				solver->addClause({
+					-var->pigeonInHole(pigeons[a], hole),
+					-var->pigeonInHole(pigeons[b], hole)
+				});
+				numAdded += 1;
+			}
+		}
+		return numAdded;
+	}
+
+	void updateDecisionLoggedData() {
+		auto& result = SolveMetrics::current().result("decisionOrder");
+		result["numLiterals"] = decisions->size();
+		result["numCalls"] = decisions->getNumCalls();
+		result["numRounds"] = decisions->getNumRounds();
+	}
+
+	void updateScheduleLoggedData(unsigned numEncoded, unsigned numSolved) {
+		auto& result = SolveMetrics::current().result("schedule");
+		result["name"] = schedule.name();
+		result["stride"] = schedule.getStride();
+		result["numEncoded"] = numEncoded;
+		result["numSolved"] = numSolved;
+	}
+
+	void updateLazyLoggedData() {
+		auto& lazy = SolveMetrics::current().result("lazyAtMostOne");
+
+		unsigned numPairs = numPigeons * (numPigeons - 1) / 2;
+		lazy["numRefinements"] = numRefinements;
+		lazy["numMaterialized"] = numMaterialized;
+		lazy["numEager"] = numPairs * lazyHoles.size();
+
+		LOG(INFO) << "refinements: " << numRefinements
+			<< " at most one clauses: " << numMaterialized
+			<< " of " << numPairs * lazyHoles.size();
+	}
+};
+
+typedef ContainerCombinator<HelperVariableContainer, BasicVariableContainer> hvc;
+
+class SimpleIncrementalPHPEncoder: public UniversalPHPEncoder {
+public:
+	SimpleIncrementalPHPEncoder(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned numPigeons):
+
+		UniversalPHPEncoder(
+				std::move(_solver),
+				std::make_unique<hvc>(
+					numPigeons, selectedVariableLayout()),
+				numPigeons
+			)
+		{
+			hvar = dynamic_cast<hvc*>(getVar());
+		}
+
+	virtual void solve(){
+		solveScheduled(
+			[this](unsigned numHoles) {
+				addAtMostOnePigeonInHole(numHoles - 1);
+				addAtLeastOneHolePerPigeon(numHoles, hvar->helper(numHoles - 1));
+			},
+			[this](unsigned numHoles) {
+				assume(-hvar->helper(numHoles - 1));
+				bool solved = (solveAssumed() == ipasir::SolveResult::SAT);
+				assert(!solved);
+				return solved;
+			});
+	}
+
+	virtual ~SimpleIncrementalPHPEncoder(){}
+
+private:
+	hvc* hvar;
+};
+
+typedef ContainerCombinator<VariableContainer3SAT, BasicVariableContainer> svc;
+
+class PHPEncoder3SAT: public UniversalPHPEncoder {
+public:
+	PHPEncoder3SAT(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numPigeons):
+		UniversalPHPEncoder(
+			std::move(_solver),
+			std::make_unique<svc>(_numPigeons, selectedVariableLayout()),
+			_numPigeons
+		) {
+
+	}
+
+	PHPEncoder3SAT(
+			std::unique_ptr<ipasir::Ipasir> _solver,
+			std::unique_ptr<VariableContainer3SAT> _var,
+			unsigned _numPigeons):
+
+			UniversalPHPEncoder(
+				std::move(_solver),
+				std::move(_var),
+				_numPigeons
+				)
+		{
+
+		}
+
+	virtual void addLowerBorder() {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		for (unsigned p = 0; p < numPigeons; p++) {
+			solver->addClause({ var->connector(p, 0)});
+		}
+	}
+
+	virtual void addBorders(bool forceUppberBound = false) {
+		addLowerBorder();
+		if (forceUppberBound || fixedUpperBound.getValue()) {
+			addUpperBorder();
+		}
+	}
+
+	virtual void addHole(unsigned hole) {
+		connectorClauses(hole, *solver);
+		addAtMostOnePigeonInHole(hole);
+	}
+
+	/**
+	 * Same as addHole for the first numHoles holes, the holes are generated
+	 * in parallel.
+	 */
+	void addHoles(unsigned numHoles) {
+		if (lazyAtMostOne.getValue()) {
+			for (unsigned hole = 0; hole < numHoles; hole++) {
+				addHole(hole);
+			}
+			return;
+		}
+
+		generateClauses(*solver, numHoles, numEncodeThreads,
+			[this](unsigned hole, auto& out) {
+				connectorClauses(hole, out);
+				atMostOnePigeonInHole(hole, out);
+			});
+	}
+
+	virtual void addUpperBorder() {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		for (unsigned p = 0; p < numPigeons; p++) {
+			solver->addClause({ -var->connector(p, numPigeons - 1)});
+		}
+	}
+
+	/**
+	 * Additionally connectorFirst: the connectors of each pigeon from the
+	 * first hole on, negated, which places the pigeon into the first free
+	 * hole, then the holes in holeMajor order.
+	 */
+	virtual std::vector<int> decisionOrder(const std::string& heuristic) {
+		if (heuristic != "connectorFirst") {
+			return UniversalPHPEncoder::decisionOrder(heuristic);
+		}
+
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+		std::vector<int> order;
+		for (unsigned p = 0; p < numPigeons; p++) {
+			for (unsigned hole = 1; hole < numPigeons - 1; hole++) {
+				order.push_back(-var->connector(p, hole));
+			}
+		}
+		std::vector<int> holes = UniversalPHPEncoder::decisionOrder("holeMajor");
+		order.insert(order.end(), holes.begin(), holes.end());
+		return order;
+	}
+
+	virtual void assumeAll(unsigned i) {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		for (unsigned p = 0; p < numPigeons; p++) {
+			assume(-var->connector(p, i));
+		}
+
+		bool solved = (solveAssumed() == ipasir::SolveResult::SAT);
+		assert(!solved);
+	}
+
+	virtual void solve() {
+		solve(false);
+	}
+
+	virtual void solveIncremental() {
+		solve(true);
+	}
+
+	virtual void encode() {
+		addBorders();
+		addHoles(numPigeons - 1);
+	}
+
+	virtual std::vector<int> goalAssumptions() {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		std::vector<int> result;
+		for (unsigned p = 0; p < numPigeons; p++) {
+			result.push_back(-var->connector(p, numPigeons - 1));
+		}
+		return result;
+	}
+
+	virtual void solve(bool incremental){
+		if (incremental) {
+			addBorders();
+			// assumeAll asserts that the makespan is unsatisfiable
+			solveScheduled(
+				[this](unsigned numHoles) {
+					addHole(numHoles - 1);
+				},
+				[this](unsigned numHoles) {
+					assumeAll(numHoles);
+					return false;
+				});
+		} else {
+			encode();
+			unsigned numHoles = numPigeons - 1;
+			CollectData::MakespanAndTime m(numHoles);
+			assumeAll(numHoles);
+		}
+	}
+
+	virtual ~PHPEncoder3SAT() {};
+
+protected:
+	template<class Sink>
+	void connectorClauses(unsigned hole, Sink& out) {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		for (unsigned p = 0; p < numPigeons; p++) {
+			out.addClause({
+				-var->connector(p,hole),
+				 var->pigeonInHole(p, hole),
+				 var->connector(p, hole + 1)
+			});
+		}
+	}
+};
+
+class AlternatePHPEncoder3SAT: public PHPEncoder3SAT {
+public:
+	AlternatePHPEncoder3SAT(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numPigeons):
+		PHPEncoder3SAT(
+			std::move(_solver),
+			std::make_unique<svc>(_numPigeons, selectedVariableLayout()),
+			_numPigeons
+		) {
+
+	}
+
+	virtual void assumeAll(unsigned numHoles) {
+		VariableContainer3SAT* var =
+			dynamic_cast<VariableContainer3SAT*>(getVar());
+
+		// cores are sets of pigeons, whose connectors of this makespan
+		// can not be false at the same time
+		SubsetIndex cores;
+		unsigned numSolved = 0;
+		unsigned numSkipped = 0;
+
+		unsigned n = numPigeons;
+		for (unsigned k = numPigeons; k >=numHoles + 1; k--) {
+			// std::cout << "n: " << n << " k: " << k << std::endl;
+
+			std::vector<bool> v(n);
+			std::fill(v.begin(), v.begin() + k, true);
+
+			do {
+				if (coreReuse.getValue()) {
+					std::vector<unsigned> assumed;
+					for (unsigned i = 0; i < n; ++i) {
+						if (v[i]) {
+							assumed.push_back(i);
+						}
+					}
+					if (cores.containsSubsetOf(assumed)) {
+						numSkipped += 1;
+						continue;
+					}
+				}
+
+				for (unsigned i = 0; i < n; ++i) {
+					if (v[i]) {
+						assume(-var->connector(i, numHoles));
+						// std::cout << i << " ";
+					}
+				}
+				// std::cout << std::endl;
+				bool unsat = (solveAssumed() == ipasir::SolveResult::UNSAT);
+				assert(unsat);
+				numSolved += 1;
+
+				std::vector<unsigned> core;
+				for (unsigned i = 0; i < n; ++i) {
+					if (v[i] && (!coreReuse.getValue()
+							|| solver->failed(-var->connector(i, numHoles)))) {
+						core.push_back(i);
+					}
+				}
+				if (coreReuse.getValue()) {
+					cores.insert(core);
+				}
+
+				if (unsat && addAssumed.getValue()) {
+					for (unsigned i: core) {
+						solver->add(var->connector(i, numHoles));
+						// std::cout << i << " ";
+					}
+					solver->add(0);
+				}
+			} while (std::prev_permutation(v.begin(), v.end()));
+		}
+
+		updateLoggedData(numSolved, numSkipped, cores.size());
+	}
+
+private:
+	void updateLoggedData(unsigned numSolved, unsigned numSkipped,
+			unsigned numCores) {
+		auto& solves = SolveMetrics::current().solves();
+
+		if (solves.size() > 0) {
+			solves.back()["numSolved"] = numSolved;
+			solves.back()["numSkipped"] = numSkipped;
+			if (coreReuse.getValue()) {
+				solves.back()["numCores"] = numCores;
+			}
+		}
+		LOG(INFO) << "solved: " << numSolved << " skipped: " << numSkipped;
+	}
+};
+
+typedef ContainerCombinator<VariableContainer3SAT, ExtendedVariableContainer> evc;
+
+class ExtendedPHPEncoder3SAT: public PHPEncoder3SAT {
+public:
+	ExtendedPHPEncoder3SAT(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		unsigned _numPigeons):
+
+		PHPEncoder3SAT(
+			std::move(_solver),
+			std::make_unique<evc>(_numPigeons, selectedVariableLayout()),
+			_numPigeons
+		)
+	{
+	}
+
+	ExtendedPHPEncoder3SAT(
+		std::unique_ptr<ipasir::Ipasir> _solver,
+		std::unique_ptr<evc> _var,
+		unsigned _numPigeons):
+
+		PHPEncoder3SAT(
+			std::move(_solver),
+			std::move(_var),
+			_numPigeons
+			)
+	{
+	}
+
+	/**
+	 * The clauses of each layer n and hole i are generated in parallel.
+	 */
+	virtual void addExtendedResolutionClauses(){
+		ExtendedVariableContainer* var =
+			dynamic_cast<ExtendedVariableContainer*>(getVar());
+
+		std::vector<std::pair<unsigned, unsigned>> ranges;
+		for (unsigned n = numPigeons; n > 2; n--) {
+			for (unsigned i = 0; i < n - 1; i++) {
+				ranges.emplace_back(n, i);
+			}
+		}
+
+		generateClauses(*solver, ranges.size(), numEncodeThreads,
+			[var, &ranges](unsigned range, auto& out) {
+				unsigned n = ranges[range].first;
+				unsigned i = ranges[range].second;
+				for (unsigned j = 0; j < n - 2; j++) {
+					out.addClause({
+						 var->pigeonInHole(n - 1, i, j),
+						-var->pigeonInHole(n, i, j)
+					});
+					out.addClause({
+						 var->pigeonInHole(n - 1, i, j),
+						-var->pigeonInHole(n, i, n - 2),
+						-var->pigeonInHole(n, n - 1, j)
+					});
+					out.addClause({
+						-var->pigeonInHole(n - 1, i, j),
+						 var->pigeonInHole(n, i, j),
+						 var->pigeonInHole(n, i, n - 2)
+					});
+					out.addClause({
+						-var->pigeonInHole(n - 1, i, j),
+						 var->pigeonInHole(n, i, j),
+						 var->pigeonInHole(n, n - 1, j)
+					});
+				}
+			});
+	}
+
+	/**
+	 * Number of processes which answer the queries of learnClauses, 0 uses
+	 * all cores. With more than one, the queries of a step are solved in
+	 * forked copies of the solver and the proven clauses are added to it.
+	 */
+	void setLearnWorkers(unsigned numWorkers) {
+		numLearnWorkers = numWorkers;
+	}
+
+	/**
+	 * A worker which answers no query for this many seconds is killed and
+	 * its queries are solved in this process, 0 waits without a limit.
+	 */
+	void setLearnTimeout(double timeout) {
+		learnTimeout = timeout;
+	}
+
+	virtual void learnClauses(unsigned step){
+		unsigned sn = numPigeons;
+		ExtendedVariableContainer* var =
+			dynamic_cast<ExtendedVariableContainer*>(getVar());
+
+		if (numLearnWorkers != 1) {
+			learnClausesForked(step);
+			return;
+		}
+
+			// learn at most one
+			for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
+				for (unsigned p = 1; p < numPigeons - step; p++) {
+					for (unsigned j = 0; j < p; j++) {
+					//carj::ScopedTimer timer((*solves.rbegin())["time"]);
+					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << p << ", " << h << ")";
+					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << j << ", " << h << ")";
+
+					std::vector<int> clause({
+						-var->pigeonInHole(sn - step, p, h),
+						-var->pigeonInHole(sn - step, j, h)
+					});
+
+					for (int lit: clause) {
+						assume(-lit);
+					}
+
+					std::set<int> clauseLiterals;
+					clauseLiterals.insert(clause.begin(),clause.end());
+
+					bool foundClause = false;
+					solver->set_learn(2, [&foundClause, &clauseLiterals](int* learned) {
+						std::set<int> learnedLiterals;
+						while(*learned != 0) {
+							learnedLiterals.insert(*learned);
+							learned++;
+						}
+
+						foundClause |= (learnedLiterals == clauseLiterals);
+					});
+
+					bool solved = (solveAssumed() == ipasir::SolveResult::SAT);
+					assert(!solved);
+
+					solver->set_learn(0, [](int*){});
+					}
+				}
+			}
+
+			// learn at least one
+			for (unsigned p = 1; p < numPigeons - step; p++) {
+				for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
+					//carj::ScopedTimer timer((*solves.rbegin())["time"]);
+					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << p << ", " << h << ")";
+					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << j << ", " << h << ")";
+					assume(-var->pigeonInHole(sn - step, p, h));
+				}
+				bool solved = (solveAssumed() == ipasir::SolveResult::SAT);
+				assert(!solved);
+			}
+	}
+
+	virtual void solve() {
+		solve(false);
+	}
+
+	virtual void solveIncremental() {
+		solve(true);
+	}
+
+	virtual void encode() {
+		addBorders(true);
+		addHoles(numPigeons - 1);
+		addExtendedResolutionClauses();
+	}
+
+	virtual std::vector<int> goalAssumptions() {
+		return {};
+	}
+
+	virtual void solve(bool incremental){
+		// solver->set_learn(10000, [](int* learned) {
+		// 	for(;*learned != 0;learned++) {
+		// 		std::cout << *learned << " ";
+		// 	}
+		// 	std::cout << std::endl;
+		// });
+
+		bool solved;
+		encode();
+
+		if (incremental) {
+			for (unsigned step = 1; step < numPigeons; step++) {
+				CollectData::MakespanAndTime m(step);
+				learnClauses(step);
+			}
+		}
+
+		solved = (solveAssumed() == ipasir::SolveResult::SAT);
+		assert(!solved);
+	}
+
+	virtual ~ExtendedPHPEncoder3SAT(){
+
+	}
+
+protected:
+	unsigned numLearnWorkers = 1;
+	double learnTimeout = 0;
+
+	/**
+	 * Queries the same clauses as learnClauses, the at most one clauses
+	 * before the at least one clauses. The workers do not pass learned
+	 * clauses back, so each clause which is proven is added instead.
+	 */
+	void learnClausesForked(unsigned step) {
+		unsigned sn = numPigeons;
+		ExtendedVariableContainer* var =
+			dynamic_cast<ExtendedVariableContainer*>(getVar());
+
+		std::vector<std::vector<int>> atMostOne;
+		for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
+			for (unsigned p = 1; p < numPigeons - step; p++) {
+				for (unsigned j = 0; j < p; j++) {
+					atMostOne.push_back({
+						-var->pigeonInHole(sn - step, p, h),
+						-var->pigeonInHole(sn - step, j, h)
+					});
+				}
+			}
+		}
+
+		std::vector<std::vector<int>> atLeastOne;
+		for (unsigned p = 1; p < numPigeons - step; p++) {
+			atLeastOne.emplace_back();
+			for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
+				atLeastOne.back().push_back(var->pigeonInHole(sn - step, p, h));
+			}
+		}
+
+		std::vector<ForkedQuery> results = proveForked(atMostOne);
+		std::vector<ForkedQuery> atLeastOneResults = proveForked(atLeastOne);
+		results.insert(results.end(),
+			atLeastOneResults.begin(), atLeastOneResults.end());
+		updateForkedLoggedData(results);
+	}
+
+	std::vector<ForkedQuery> proveForked(
+			const std::vector<std::vector<int>>& clauses) {
+		std::vector<ForkedQuery> results = solveForked(
+			clauses.size(), numLearnWorkers,
+			[this, &clauses](unsigned query) {
+				for (int lit: clauses[query]) {
+					assume(-lit);
+				}
+				return solveAssumed(false);
+			}, learnTimeout);
+
+		for (unsigned i = 0; i < clauses.size(); i++) {
+			assert(results[i].result != ipasir::SolveResult::SAT);
+			if (results[i].result == ipasir::SolveResult::UNSAT) {
+				solver->addClause(clauses[i]);
+			}
+		}
+		return results;
+	}
+
+private:
+	void updateForkedLoggedData(const std::vector<ForkedQuery>& results) {
+		auto& solves = SolveMetrics::current().solves();
+
+		unsigned numProven = 0;
+		unsigned numLocal = 0;
+		double queryTime = 0;
+		double maxQueryTime = 0;
+		for (const ForkedQuery& result: results) {
+			numProven += (result.result == ipasir::SolveResult::UNSAT);
+			numLocal += (result.worker < 0);
+			queryTime += result.time;
+			maxQueryTime = std::max(maxQueryTime, result.time);
+		}
+
+		if (solves.size() > 0) {
+			solves.back()["numQueries"] = results.size();
+			solves.back()["numProven"] = numProven;
+			solves.back()["numLocal"] = numLocal;
+			solves.back()["queryTime"] = queryTime;
+			solves.back()["maxQueryTime"] = maxQueryTime;
+		}
+	}
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Clauses of one range, zero terminated as for Ipasir::add.
+ */
+class ClauseBuffer {
+public:
+	void add(int lit_or_zero) {
+		literals.push_back(lit_or_zero);
+	}
+
+	void addClause(std::initializer_list<int> clause) {
+		literals.insert(literals.end(), clause.begin(), clause.end());
+		literals.push_back(0);
+	}
+
+	void flush(ipasir::Ipasir& solver) {
+		for (int lit: literals) {
+			solver.add(lit);
+		}
+		std::vector<int>().swap(literals);
+	}
+
+private:
+	std::vector<int> literals;
+};
+
+/**
+ * Calls generate(range, sink) for each range in [0, numRanges) and passes
+ * the clauses to the solver in the order of the ranges, so the formula is
+ * the same for any number of threads. The sink is the solver itself if only
+ * one thread is used and a ClauseBuffer otherwise, so generate has to be
+ * generic in the sink and must only read shared state.
+ *
+ * The workers take the ranges in order, the calling thread passes each
+ * buffer to the solver as soon as it is complete and frees it.
+ *
+ * numThreads 0 uses all cores.
+ */
+template<class Generate>
+void generateClauses(
+		ipasir::Ipasir& solver,
+		unsigned numRanges,
+		unsigned numThreads,
+		Generate generate) {
+
+	if (numThreads == 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	numThreads = std::min(numThreads, numRanges);
+
+	if (numThreads <= 1) {
+		for (unsigned range = 0; range < numRanges; range++) {
+			generate(range, solver);
+		}
+		return;
+	}
+
+	std::vector<ClauseBuffer> buffers(numRanges);
+	std::vector<char> done(numRanges, false);
+	std::atomic<unsigned> next(0);
+	std::mutex mutex;
+	std::condition_variable completed;
+
+	auto work = [&]() {
+		for (unsigned range = next++; range < numRanges; range = next++) {
+			generate(range, buffers[range]);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				done[range] = true;
+			}
+			completed.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < numThreads; i++) {
+		workers.emplace_back(work);
+	}
+
+	for (unsigned range = 0; range < numRanges; range++) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completed.wait(lock, [&]() { return done[range] != 0; });
+		}
+		buffers[range].flush(solver);
+	}
+
+	for (std::thread& worker: workers) {
+		worker.join();
+	}
+}
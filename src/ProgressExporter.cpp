@@ -0,0 +1,169 @@
+#include "ProgressExporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+	std::int64_t nanoseconds(std::chrono::steady_clock::time_point time) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			time.time_since_epoch()).count();
+	}
+
+	/**
+	 * Resident set size in bytes, 0 if it can not be read.
+	 */
+	std::uint64_t residentSetSize() {
+		std::ifstream statm("/proc/self/statm");
+		std::uint64_t size = 0;
+		std::uint64_t resident = 0;
+		if (!(statm >> size >> resident)) {
+			return 0;
+		}
+		return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	}
+}
+
+ProgressCounters& progressCounters() {
+	static ProgressCounters counters;
+	return counters;
+}
+
+ProgressExporter::ProgressExporter(std::string _path, double _interval,
+		Format _format):
+	path(_path),
+	tmpPath(_path + ".tmp"),
+	interval(std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(_interval))),
+	format(_format),
+	start(Clock::now()),
+	owner(getpid()),
+	lastSample(nanoseconds(start)),
+	stopped(false)
+{
+	sample();
+	timer = std::thread(&ProgressExporter::runTimer, this);
+}
+
+ProgressExporter::~ProgressExporter() {
+	{
+		std::lock_guard<std::mutex> lock(timerMutex);
+		stopped = true;
+	}
+	wakeup.notify_one();
+	timer.join();
+	sample();
+}
+
+bool ProgressExporter::isDue() {
+	Clock::duration sinceLast = Clock::now().time_since_epoch()
+		- std::chrono::nanoseconds(lastSample.load());
+	return sinceLast >= interval;
+}
+
+void ProgressExporter::sampleIfDue() {
+	if (isDue()) {
+		sample();
+	}
+}
+
+void ProgressExporter::runTimer() {
+	std::unique_lock<std::mutex> lock(timerMutex);
+	while (!stopped) {
+		wakeup.wait_for(lock, interval);
+		if (!stopped && isDue()) {
+			sample();
+		}
+	}
+}
+
+void ProgressExporter::sample() {
+	if (getpid() != owner) {
+		return;
+	}
+
+	// an other thread is writing a sample right now
+	std::unique_lock<std::mutex> lock(writeMutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+	lastSample = nanoseconds(Clock::now());
+
+	std::string contents = render();
+	std::FILE* file = std::fopen(tmpPath.c_str(), "w");
+	bool failed = (file == nullptr);
+	if (file != nullptr) {
+		failed |= std::fwrite(contents.data(), 1, contents.size(), file)
+			!= contents.size();
+		failed |= std::fclose(file) != 0;
+	}
+	if (failed || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+		std::remove(tmpPath.c_str());
+	}
+}
+
+std::string ProgressExporter::render() {
+	ProgressCounters& counters = progressCounters();
+	Clock::time_point now = Clock::now();
+
+	double elapsed = std::chrono::duration<double>(now - start).count();
+	double solveTime = 0;
+	bool solving = counters.solving;
+	if (solving) {
+		solveTime = std::chrono::duration<double>(
+			now.time_since_epoch()
+			- std::chrono::nanoseconds(counters.solveStart.load())).count();
+	}
+
+	std::stringstream out;
+	out.precision(15);
+	if (format == Format::JSON) {
+		out << "{"
+			<< "\"elapsed\": " << elapsed << ", "
+			<< "\"makespan\": " << counters.makespan << ", "
+			<< "\"solving\": " << (solving ? "true" : "false") << ", "
+			<< "\"solveTime\": " << solveTime << ", "
+			<< "\"numSolves\": " << counters.numSolves << ", "
+			<< "\"numLearned\": " << counters.numLearned << ", "
+			<< "\"numTerminateCalls\": " << counters.numTerminateCalls << ", "
+			<< "\"rss\": " << residentSetSize()
+			<< "}\n";
+	} else {
+		auto metric = [&out](const char* name, const char* type,
+				const char* help, double value) {
+			out << "# HELP incphp_" << name << " " << help << "\n"
+				<< "# TYPE incphp_" << name << " " << type << "\n"
+				<< "incphp_" << name << " " << value << "\n";
+		};
+		metric("elapsed_seconds", "gauge", "Time since the start.", elapsed);
+		metric("makespan", "gauge", "Makespan of the current solve.",
+			counters.makespan);
+		metric("solving", "gauge", "1 while the solver is running.",
+			solving ? 1 : 0);
+		metric("solve_seconds", "gauge", "Time in the current solve.",
+			solveTime);
+		metric("solves_total", "counter", "Finished solves.",
+			counters.numSolves);
+		metric("learned_clauses_total", "counter", "Learned clauses.",
+			counters.numLearned);
+		metric("terminate_calls_total", "counter",
+			"Calls of the terminate callback.", counters.numTerminateCalls);
+		metric("resident_bytes", "gauge", "Resident set size.",
+			residentSetSize());
+	}
+	return out.str();
+}
+
+bool ProgressExporter::formatFromName(const std::string& name,
+		Format& format) {
+	if (name == "json") {
+		format = Format::JSON;
+	} else if (name == "prometheus") {
+		format = Format::PROMETHEUS;
+	} else {
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+/**
+ * State of the running process, which is written by the solving thread and
+ * read by the ProgressExporter.
+ */
+struct ProgressCounters {
+	std::atomic<unsigned> makespan{0};
+	std::atomic<std::uint64_t> numSolves{0};
+	std::atomic<std::uint64_t> numLearned{0};
+	std::atomic<std::uint64_t> numTerminateCalls{0};
+	std::atomic<bool> solving{false};
+	/**
+	 * Start of the current or last solve, nanoseconds of the steady clock.
+	 */
+	std::atomic<std::int64_t> solveStart{0};
+};
+
+ProgressCounters& progressCounters();
+
+/**
+ * Writes the progress counters and the resident set size to a small file,
+ * so that long runs can be watched from outside. The file is replaced
+ * atomically by a rename. A sample is written by the timer thread after
+ * each interval without one, and by the solving thread through sampleIfDue
+ * from the terminate callback, so that a frozen file means a frozen process.
+ * numTerminateCalls stops growing if the solver itself is stuck.
+ *
+ * The format is either json or prometheus (text exposition format).
+ *
+ * Only the process which created the exporter writes samples, forked
+ * processes keep their counters to themselves.
+ */
+class ProgressExporter {
+public:
+	enum class Format {
+		JSON,
+		PROMETHEUS
+	};
+
+	ProgressExporter(std::string path, double interval, Format format);
+
+	/**
+	 * Stops the timer thread and writes a last sample.
+	 */
+	~ProgressExporter();
+
+	void sampleIfDue();
+
+	/**
+	 * Write a sample now.
+	 */
+	void sample();
+
+	/**
+	 * Current contents of the file.
+	 */
+	std::string render();
+
+	/**
+	 * Returns false for an unknown name.
+	 */
+	static bool formatFromName(const std::string& name, Format& format);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::string path;
+	std::string tmpPath;
+	Clock::duration interval;
+	Format format;
+	Clock::time_point start;
+	pid_t owner;
+
+	std::atomic<std::int64_t> lastSample;
+	std::mutex writeMutex;
+
+	std::mutex timerMutex;
+	std::condition_variable wakeup;
+	bool stopped;
+	std::thread timer;
+
+	void runTimer();
+	bool isDue();
+};
+
+/**
+ * Counts solves, learned clauses and calls of the terminate callback for
+ * the ProgressExporter. Learned clauses up to learnLength literals are
+ * counted, clauses set by set_learn from above are passed on with their own
+ * limit.
+ */
+class ProgressDecorator: public ipasir::Ipasir {
+public:
+	ProgressDecorator(
+			std::unique_ptr<Ipasir> _solver,
+			ProgressExporter* _exporter,
+			int _learnLength):
+		solver(std::move(_solver)),
+		exporter(_exporter),
+		learnLength(_learnLength),
+		terminateCallback([]{return 0;}),
+		maxLength(0),
+		learnCallback([](int*){})
+	{
+		setTerminate();
+		setLearn();
+	}
+
+	virtual std::string signature() {
+		return solver->signature();
+	}
+
+	virtual void add(int lit_or_zero) {
+		solver->add(lit_or_zero);
+	}
+
+	virtual void assume(int lit) {
+		solver->assume(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		ProgressCounters& counters = progressCounters();
+		counters.solveStart = std::chrono::duration_cast<
+				std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		counters.solving = true;
+		ipasir::SolveResult result = solver->solve();
+		counters.solving = false;
+		counters.numSolves += 1;
+		return result;
+	}
+
+	virtual int val(int lit) {
+		return solver->val(lit);
+	}
+
+	virtual int failed(int lit) {
+		return solver->failed(lit);
+	}
+
+	virtual void set_terminate(std::function<int(void)> callback) {
+		terminateCallback = callback;
+	}
+
+	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
+		maxLength = max_length;
+		learnCallback = callback;
+		setLearn();
+	}
+
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		solver->set_select_literal(callback);
+	}
+
+	virtual void reset() {
+		solver->reset();
+		setTerminate();
+		setLearn();
+	}
+
+private:
+	std::unique_ptr<Ipasir> solver;
+	ProgressExporter* exporter;
+	int learnLength;
+
+	std::function<int(void)> terminateCallback;
+	int maxLength;
+	std::function<void(int*)> learnCallback;
+
+	void setTerminate() {
+		solver->set_terminate([this]() {
+			progressCounters().numTerminateCalls += 1;
+			exporter->sampleIfDue();
+			return terminateCallback();
+		});
+	}
+
+	void setLearn() {
+		solver->set_learn(std::max(learnLength, maxLength),
+			[this](int* learned) {
+				int length = 0;
+				while (learned[length] != 0) {
+					length += 1;
+				}
+				if (length <= learnLength) {
+					progressCounters().numLearned += 1;
+				}
+				if (length <= maxLength) {
+					learnCallback(learned);
+				}
+			});
+	}
+};
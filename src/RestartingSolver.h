@@ -0,0 +1,202 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "SolveMetrics.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Restarts solves which take too long. Each solve gets attempts with time
+ * budgets of budget * luby(i), which are enforced through set_terminate.
+ * After an attempt runs out of time, the solver below is reset, all clauses
+ * added so far are replayed and the solve is tried again.
+ *
+ * The layer below is expected to be randomized: resetting it draws a new
+ * permutation, so each attempt is a solve with a different seed. Callbacks
+ * set from above are set again after each reset.
+ */
+class RestartingSolver: public ipasir::Ipasir {
+public:
+	RestartingSolver(std::unique_ptr<Ipasir> _solver, double _budget):
+			solver(std::move(_solver)),
+			budget(_budget),
+			terminateCallback([]{return 0;}),
+			setLearn([]{}),
+			setSelectLiteral([]{}),
+			limit(0),
+			terminatedAbove(false),
+			numRestarts(0) {
+		setTerminate();
+	}
+
+	virtual ~RestartingSolver() {
+		LOG(INFO) << "restarts: " << numRestarts;
+	}
+
+	virtual std::string signature() {
+		return solver->signature();
+	}
+
+	virtual void add(int lit_or_zero) {
+		clauses.push_back(lit_or_zero);
+		solver->add(lit_or_zero);
+	}
+
+	virtual void assume(int lit) {
+		assumptions.push_back(lit);
+		solver->assume(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		auto& solves = SolveMetrics::current().solves();
+		json attemptTimes = json::array();
+
+		ipasir::SolveResult result;
+		for (unsigned attempt = 1;; attempt++) {
+			if (attempt > 1) {
+				restart();
+			}
+
+			start = std::chrono::steady_clock::now();
+			limit = budget * luby(attempt);
+			terminatedAbove = false;
+			result = solver->solve();
+
+			std::chrono::duration<double> elapsed =
+				std::chrono::steady_clock::now() - start;
+			attemptTimes.push_back(elapsed.count());
+
+			// a timeout requested from above is passed on
+			if (result != ipasir::SolveResult::TIMEOUT || terminatedAbove) {
+				break;
+			}
+		}
+		assumptions.clear();
+
+		if (solves.size() > 0) {
+			json& attempts = solves.back()["attempts"];
+			for (auto& time: attemptTimes) {
+				attempts.push_back(time);
+			}
+		}
+		updateLoggedData();
+		return result;
+	}
+
+	virtual int val(int lit) {
+		return solver->val(lit);
+	}
+
+	virtual int failed(int lit) {
+		return solver->failed(lit);
+	}
+
+	virtual void set_terminate(std::function<int(void)> callback) {
+		terminateCallback = callback;
+	}
+
+	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
+		setLearn = [this, max_length, callback]() {
+			solver->set_learn(max_length, callback);
+		};
+		setLearn();
+	}
+
+	virtual void set_learn_batch(int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		setLearn = [this, max_length, callback]() {
+			solver->set_learn_batch(max_length, callback);
+		};
+		setLearn();
+	}
+
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		setSelectLiteral = [this, callback]() {
+			solver->set_select_literal(callback);
+		};
+		setSelectLiteral();
+	}
+
+	virtual void reset() {
+		clauses.clear();
+		assumptions.clear();
+		resetBelow();
+	}
+
+	/**
+	 * The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ... for i >= 1.
+	 */
+	static unsigned luby(unsigned i) {
+		unsigned size = 1;
+		while (size < i) {
+			size = 2 * size + 1;
+		}
+		while (size != i) {
+			size = (size - 1) / 2;
+			if (i > size) {
+				i -= size;
+			}
+		}
+		return (size + 1) / 2;
+	}
+
+private:
+	using json = nlohmann::json;
+
+	std::unique_ptr<Ipasir> solver;
+	double budget;
+
+	std::vector<int> clauses;
+	std::vector<int> assumptions;
+
+	std::function<int(void)> terminateCallback;
+	std::function<void()> setLearn;
+	std::function<void()> setSelectLiteral;
+
+	std::chrono::steady_clock::time_point start;
+	double limit;
+	bool terminatedAbove;
+	unsigned numRestarts;
+
+	void setTerminate() {
+		solver->set_terminate([this]() {
+			terminatedAbove = terminateCallback() != 0;
+			if (terminatedAbove) {
+				return 1;
+			}
+			std::chrono::duration<double> elapsed =
+				std::chrono::steady_clock::now() - start;
+			return (elapsed.count() > limit) ? 1 : 0;
+		});
+	}
+
+	void resetBelow() {
+		solver->reset();
+		setTerminate();
+		setLearn();
+		setSelectLiteral();
+	}
+
+	void restart() {
+		numRestarts += 1;
+		resetBelow();
+		for (int lit: clauses) {
+			solver->add(lit);
+		}
+		for (int lit: assumptions) {
+			solver->assume(lit);
+		}
+	}
+
+	void updateLoggedData() {
+		auto& restarts = SolveMetrics::current().result("restarts");
+		restarts["numRestarts"] = numRestarts;
+		restarts["budget"] = budget;
+	}
+};
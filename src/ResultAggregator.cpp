@@ -0,0 +1,222 @@
+#include "ResultAggregator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <utility>
+
+#include "carj/Statistics.h"
+
+namespace {
+	std::string csvField(const std::string& text) {
+		if (text.find_first_of(",\"\n") == std::string::npos) {
+			return text;
+		}
+		std::string result = "\"";
+		for (char c: text) {
+			if (c == '"') {
+				result += '"';
+			}
+			result += c;
+		}
+		return result + "\"";
+	}
+
+	std::string csvField(const nlohmann::json& value) {
+		if (value.is_null()) {
+			return "";
+		} else if (value.is_string()) {
+			return csvField(value.get<std::string>());
+		}
+		return csvField(value.dump());
+	}
+
+	/**
+	 * Nested objects become fields named by their path, i.e. setup.solver.
+	 */
+	void flatten(const nlohmann::json& object, const std::string& prefix,
+			nlohmann::json& result) {
+		for (auto it = object.begin(); it != object.end(); ++it) {
+			if (it.value().is_object()) {
+				flatten(it.value(), prefix + it.key() + ".", result);
+			} else {
+				result[prefix + it.key()] = it.value();
+			}
+		}
+	}
+}
+
+ResultAggregator::ResultAggregator(std::vector<std::string> _ignored):
+	ignored(_ignored),
+	numRuns(0)
+{
+}
+
+std::size_t ResultAggregator::addDocument(const json& document) {
+	if (!document.is_object()) {
+		return 0;
+	}
+
+	std::size_t numAdded = 0;
+	auto runResults = document.find("runResults");
+	if (runResults != document.end() && runResults->is_array()) {
+		for (const json& run: *runResults) {
+			if (!run.is_object() || run.count("incphp") == 0) {
+				continue;
+			}
+			// the parameters of incphp may still hold templates of the
+			// experiment, the resolved conf names the configuration
+			json parameters = json::object();
+			auto conf = run.find("conf");
+			if (conf != run.end() && conf->is_object()) {
+				json configuration = *conf;
+				configuration.erase("run");
+				flatten(configuration, "", parameters);
+			}
+			addRun(run["incphp"], parameters);
+			numAdded += 1;
+		}
+	} else if (document.count("incphp") != 0) {
+		const json& run = document["incphp"];
+		json parameters = json::object();
+		if (run.is_object() && run.count("parameters") != 0
+				&& run["parameters"].is_object()) {
+			parameters = run["parameters"];
+		}
+		addRun(run, parameters);
+		numAdded += 1;
+	}
+	return numAdded;
+}
+
+bool ResultAggregator::addFile(const std::string& path) {
+	std::ifstream in(path);
+	if (!in) {
+		return false;
+	}
+
+	json document;
+	try {
+		in >> document;
+	} catch (std::exception&) {
+		return false;
+	}
+	addDocument(document);
+	return true;
+}
+
+void ResultAggregator::addRun(const json& run, json parameters) {
+	if (!run.is_object()) {
+		return;
+	}
+
+	for (const std::string& name: ignored) {
+		parameters.erase(name);
+	}
+
+	std::string configuration = parameters.dump();
+	configurations.emplace(configuration, parameters);
+	runsPerConfiguration[configuration] += 1;
+	numRuns += 1;
+
+	if (run.count("result") == 0 || !run["result"].is_object()) {
+		return;
+	}
+	const json& result = run["result"];
+
+	auto solves = result.find("solves");
+	if (solves != result.end() && solves->is_array()) {
+		for (const json& solve: *solves) {
+			if (solve.is_object() && solve.count("makespan") != 0
+					&& solve["makespan"].is_number()) {
+				addFields(configuration, "solves.", solve,
+					solve["makespan"].get<long>(), {"makespan"});
+			}
+		}
+	}
+
+	for (const char* name: {"learnedClauseEval", "executionTime"}) {
+		auto object = result.find(name);
+		if (object != result.end()) {
+			addFields(configuration, std::string(name) + ".", *object,
+				noMakespan);
+		}
+	}
+}
+
+void ResultAggregator::addFields(const std::string& configuration,
+		const std::string& prefix, const json& object, long makespan,
+		const std::vector<std::string>& skip) {
+	if (!object.is_object()) {
+		return;
+	}
+	for (auto it = object.begin(); it != object.end(); ++it) {
+		if (!it.value().is_number() || std::find(skip.begin(), skip.end(),
+				it.key()) != skip.end()) {
+			continue;
+		}
+		samples[Key(configuration, prefix + it.key(), makespan)]
+			.push_back(it.value().get<double>());
+	}
+}
+
+void ResultAggregator::merge(const ResultAggregator& other) {
+	numRuns += other.numRuns;
+	for (const auto& configuration: other.configurations) {
+		configurations.insert(configuration);
+	}
+	for (const auto& runs: other.runsPerConfiguration) {
+		runsPerConfiguration[runs.first] += runs.second;
+	}
+	for (const auto& metric: other.samples) {
+		std::vector<double>& values = samples[metric.first];
+		values.insert(values.end(), metric.second.begin(), metric.second.end());
+	}
+}
+
+void ResultAggregator::writeCsv(std::ostream& out) const {
+	std::set<std::string> columns;
+	for (const auto& configuration: configurations) {
+		for (auto it = configuration.second.begin();
+				it != configuration.second.end(); ++it) {
+			columns.insert(it.key());
+		}
+	}
+
+	const std::vector<std::string> statistics = {"count", "mean", "min",
+		"max", "median", "q1", "q3", "iqr", "medianCiLow", "medianCiHigh"};
+
+	for (const std::string& column: columns) {
+		out << csvField(column) << ",";
+	}
+	out << "numRuns,metric,makespan";
+	for (const std::string& statistic: statistics) {
+		out << "," << statistic;
+	}
+	out << "\n";
+
+	out.precision(15);
+	for (const auto& metric: samples) {
+		const std::string& configuration = std::get<0>(metric.first);
+		const json& parameters = configurations.at(configuration);
+		for (const std::string& column: columns) {
+			auto value = parameters.find(column);
+			if (value != parameters.end()) {
+				out << csvField(*value);
+			}
+			out << ",";
+		}
+
+		out << runsPerConfiguration.at(configuration) << ","
+			<< csvField(std::get<1>(metric.first)) << ",";
+		if (std::get<2>(metric.first) != noMakespan) {
+			out << std::get<2>(metric.first);
+		}
+
+		json summary = carj::summarize(metric.second).toJson();
+		for (const std::string& statistic: statistics) {
+			out << "," << summary[statistic].get<double>();
+		}
+		out << "\n";
+	}
+}
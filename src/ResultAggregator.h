@@ -0,0 +1,75 @@
+#pragma once
+
+#include "json.hpp"
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * Collects the results of many runs, as written to carj.json or to the
+ * runResults of an experimentrun result file, and summarizes them per
+ * configuration. A configuration is the parameters of a carj.json file or
+ * the conf of an experimentrun result without its run, with nested fields
+ * named by their path, i.e. setup.solver. The ignored parameters, i.e. the
+ * seed, are dropped from both.
+ *
+ * The metrics are the numeric fields of the solves, per makespan, and of
+ * learnedClauseEval and executionTime. Only their values are kept, so the
+ * documents can be discarded after they were added.
+ */
+class ResultAggregator {
+public:
+	typedef nlohmann::json json;
+
+	ResultAggregator(std::vector<std::string> ignored = {"seed"});
+
+	/**
+	 * Add the runs of a result document and return their number.
+	 */
+	std::size_t addDocument(const json& document);
+
+	/**
+	 * Returns false if the file can not be read or parsed.
+	 */
+	bool addFile(const std::string& path);
+
+	void merge(const ResultAggregator& other);
+
+	/**
+	 * One row per configuration, metric and makespan with the parameters,
+	 * the number of runs of the configuration and the summary statistics
+	 * of the metric. The makespan is empty for metrics of the whole run.
+	 */
+	void writeCsv(std::ostream& out) const;
+
+	std::size_t getNumRuns() const {
+		return numRuns;
+	}
+
+	std::size_t getNumConfigurations() const {
+		return configurations.size();
+	}
+
+private:
+	/**
+	 * configuration, metric, makespan
+	 */
+	typedef std::tuple<std::string, std::string, long> Key;
+
+	static const long noMakespan = -1;
+
+	std::vector<std::string> ignored;
+	std::size_t numRuns;
+	std::map<std::string, json> configurations;
+	std::map<std::string, std::size_t> runsPerConfiguration;
+	std::map<Key, std::vector<double>> samples;
+
+	void addRun(const json& run, json parameters);
+	void addFields(const std::string& configuration, const std::string& prefix,
+		const json& object, long makespan,
+		const std::vector<std::string>& skip = {});
+};
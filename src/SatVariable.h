@@ -1,3 +1,5 @@
+#pragma once
+
 #include <vector>
 #include <initializer_list>
 #include <cstddef>
@@ -10,51 +12,52 @@ public:
         return operator()({args...});
     }
 
-    int operator()(std::initializer_list<unsigned> _values){
-        std::vector<unsigned> values(_values);
+    int operator()(std::initializer_list<unsigned> values){
         assert(values.size() == dimensions.size());
-        for (std::size_t i = 0; i < values.size(); i++) {
-            assert(0 <= values[i]);
-            assert(values[i] < dimensions[i]);
-        }
 
-        unsigned result = 0;
-        for (std::size_t i = 0; i < values.size(); i++) {
-            result *= dimensions[i];
-            result += values[i];
+        unsigned result = start;
+        std::size_t i = 0;
+        for (unsigned value: values) {
+            assert(value < dimensions[i]);
+            result += value * strides[i];
+            i++;
         }
-        result += start;
 
         assert(start <= result);
-        assert(result < start + numberOfVariables());
+        assert(result < end);
         return result;
     }
 
 private:
     friend class SatVariableAllocator;
 
-    SatVariable(unsigned _start, std::vector<unsigned> _dimensions):
-        dimensions(_dimensions), start(_start) {
+    SatVariable(unsigned _start, std::vector<unsigned> _dimensions,
+            std::vector<unsigned> _strides, unsigned _end):
+        dimensions(_dimensions), strides(_strides), start(_start), end(_end) {
             assert(start > 0);
     }
 
-    unsigned numberOfVariables() {
-        unsigned result = 1;
-
-        for (unsigned dim: dimensions) {
-            result *= dim;
-        }
-
-        return result;
-    }
-
     std::vector<unsigned> dimensions;
+    std::vector<unsigned> strides;
     unsigned start;
+    unsigned end;
 };
 
 class SatVariableAllocator {
 public:
-    SatVariableAllocator() {
+    /**
+     * Order of the indices within the block of a variable: ROW_MAJOR
+     * varies the last index fastest, COLUMN_MAJOR the first one.
+     */
+    enum class Layout {
+        ROW_MAJOR,
+        COLUMN_MAJOR
+    };
+
+    SatVariableAllocator(Layout _layout = Layout::ROW_MAJOR):
+        layout(_layout),
+        numShared(0),
+        numPlaced(0) {
         firstUnusedValue = 1;
     }
 
@@ -66,11 +69,106 @@ public:
     template<class ... Types>
     SatVariable<Types...> newVariable(std::initializer_list<unsigned> _dimensions) {
         std::vector<unsigned> dimensions(_dimensions);
-        SatVariable<Types...> variable = SatVariable<Types...>(firstUnusedValue, dimensions);
-        firstUnusedValue += variable.numberOfVariables();
-        return variable;
+
+        if (numPlaced < numShared && fitsShared(dimensions)) {
+            std::vector<unsigned> strides = computeStrides(sharedDimensions);
+            for (unsigned& stride: strides) {
+                stride *= numShared;
+            }
+            unsigned start = sharedStart + numPlaced;
+            numPlaced += 1;
+            return SatVariable<Types...>(start, dimensions, strides, sharedEnd);
+        }
+
+        unsigned start = firstUnusedValue;
+        firstUnusedValue += size(dimensions);
+        return SatVariable<Types...>(start, dimensions,
+            computeStrides(dimensions), firstUnusedValue);
+    }
+
+    /**
+     * A variable whose first index selects one of consecutive blocks, the
+     * layout applies to the remaining indices within each block. It never
+     * takes a shared block.
+     */
+    template<class ... Types>
+    SatVariable<Types...> newBlockedVariable(Types ... args) {
+        std::vector<unsigned> dimensions({static_cast<unsigned>(args)...});
+        std::vector<unsigned> inner(dimensions.begin() + 1, dimensions.end());
+
+        std::vector<unsigned> strides = computeStrides(inner);
+        strides.insert(strides.begin(), size(inner));
+
+        unsigned start = firstUnusedValue;
+        firstUnusedValue += size(dimensions);
+        return SatVariable<Types...>(start, dimensions, strides,
+            firstUnusedValue);
+    }
+
+    /**
+     * The next numVariables variables, which have as many dimensions and
+     * fit into the given ones, share one block. Each entry of the block
+     * holds one variable of each of them, so the variables with the same
+     * indices get consecutive numbers.
+     */
+    void interleave(std::initializer_list<unsigned> dimensions,
+            unsigned numVariables) {
+        sharedDimensions = dimensions;
+        numShared = numVariables;
+        numPlaced = 0;
+        sharedStart = firstUnusedValue;
+        firstUnusedValue += size(sharedDimensions) * numShared;
+        sharedEnd = firstUnusedValue;
+    }
+
+    unsigned numberOfVariables() {
+        return firstUnusedValue - 1;
     }
 
 private:
     int firstUnusedValue;
+    Layout layout;
+
+    std::vector<unsigned> sharedDimensions;
+    unsigned numShared;
+    unsigned numPlaced;
+    unsigned sharedStart;
+    unsigned sharedEnd;
+
+    static unsigned size(const std::vector<unsigned>& dimensions) {
+        unsigned result = 1;
+        for (unsigned dim: dimensions) {
+            result *= dim;
+        }
+        return result;
+    }
+
+    bool fitsShared(const std::vector<unsigned>& dimensions) {
+        if (dimensions.size() != sharedDimensions.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < dimensions.size(); i++) {
+            if (dimensions[i] > sharedDimensions[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<unsigned> computeStrides(const std::vector<unsigned>& dimensions) {
+        std::vector<unsigned> strides(dimensions.size());
+        unsigned stride = 1;
+        if (layout == Layout::ROW_MAJOR) {
+            for (std::size_t i = dimensions.size(); i > 0; i--) {
+                strides[i - 1] = stride;
+                stride *= dimensions[i - 1];
+            }
+        } else {
+            for (std::size_t i = 0; i < dimensions.size(); i++) {
+                strides[i] = stride;
+                stride *= dimensions[i];
+            }
+        }
+        return strides;
+    }
 };
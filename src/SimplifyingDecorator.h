@@ -0,0 +1,619 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "SolveMetrics.h"
+#include "carj/carj.h"
+#include "carj/logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Simplifies the clauses emitted by the encoder before they reach the
+ * solver. Clauses are buffered until the next solve call, then
+ *  - unit clauses are propagated, satisfied clauses are dropped and false
+ *    literals are removed,
+ *  - clauses which are subsumed by a clause given to the solver before or
+ *    by a shorter buffered clause are dropped,
+ *  - optionally variables are eliminated by clause distribution (bounded
+ *    variable elimination).
+ *
+ * Only variables which never occurred in a forwarded clause or an
+ * assumption are eliminated. If an eliminated variable occurs in a later
+ * clause or assumption, the clauses removed by its elimination are added
+ * again (restore on touch), so the simplified formula stays equivalent to
+ * the emitted one for everything the encoder can refer to. Values of
+ * eliminated variables are reconstructed in val().
+ */
+class SimplifyingDecorator: public ipasir::Ipasir {
+public:
+	SimplifyingDecorator(std::unique_ptr<Ipasir> _solver, bool _eliminate = false):
+			solver(std::move(_solver)),
+			eliminate(_eliminate) {
+		init();
+	}
+
+	virtual ~SimplifyingDecorator() {
+		updateLoggedData();
+		LOG(INFO) << "simplification: clauses " << numClausesIn
+			<< " -> " << numClausesOut
+			<< " units: " << numUnits
+			<< " subsumed: " << numSubsumed
+			<< " eliminated variables: " << numEliminated
+			<< " restored variables: " << numRestored;
+	}
+
+	virtual std::string signature() {
+		return solver->signature();
+	}
+
+	virtual void add(int lit_or_zero) {
+		modelValid = false;
+		if (lit_or_zero == 0) {
+			numClausesIn += 1;
+			numLiteralsIn += clause.size();
+			addPending(clause);
+			clause.clear();
+		} else {
+			clause.push_back(lit_or_zero);
+		}
+	}
+
+	virtual void assume(int lit) {
+		modelValid = false;
+		int var = std::abs(lit);
+		ensureVar(var);
+		restore(var);
+		frozen[var] = true;
+		assumptions.push_back(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		modelValid = false;
+		auto start = std::chrono::steady_clock::now();
+		simplify();
+		for (int lit: assumptions) {
+			solver->assume(lit);
+		}
+		assumptions.clear();
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		time += elapsed.count();
+
+		updateLoggedData();
+		return solver->solve();
+	}
+
+	virtual int val(int lit) {
+		if (!modelValid) {
+			reconstruct();
+		}
+		return (value(lit) > 0) ? lit : -lit;
+	}
+
+	virtual int failed(int lit) {
+		return solver->failed(lit);
+	}
+
+	virtual void set_terminate(std::function<int(void)> callback) {
+		solver->set_terminate(callback);
+	}
+
+	virtual void set_learn(int max_length, std::function<void(int*)> callback) {
+		solver->set_learn(max_length, callback);
+	}
+
+	virtual void set_learn_batch(int max_length,
+			std::function<void(int* begin, int* end)> callback) {
+		solver->set_learn_batch(max_length, callback);
+	}
+
+	/**
+	 * Literals of eliminated variables and of variables fixed by units are
+	 * skipped, the solver does not know them.
+	 */
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		solver->set_select_literal([this, callback]() {
+			int lit = callback();
+			while (lit != 0 && !isKnown(std::abs(lit))) {
+				lit = callback();
+			}
+			return lit;
+		});
+	}
+
+	virtual void reset() {
+		solver->reset();
+		init();
+	}
+
+private:
+	/**
+	 * Variables with more occurrences of one polarity are not eliminated.
+	 */
+	static const unsigned maxOccurrences = 16;
+	static const unsigned maxResolventLength = 24;
+
+	struct Elimination {
+		int var;
+		bool active;
+		std::vector<std::vector<int>> clauses;
+	};
+
+	std::unique_ptr<Ipasir> solver;
+	bool eliminate;
+
+	std::vector<int> clause;
+	std::vector<int> assumptions;
+	std::vector<std::vector<int>> pending;
+	bool inconsistent;
+
+	/**
+	 * Clauses given to the solver and buffered clauses, which survived
+	 * subsumption. Each clause is watched by its first literal, which is
+	 * enough to find all clauses that are a subset of a given clause.
+	 */
+	std::vector<std::vector<int>> clauses;
+	std::vector<bool> removed;
+	std::vector<std::vector<unsigned>> watches;
+
+	std::vector<signed char> assignment;
+	std::vector<bool> frozen;
+	std::vector<bool> marked;
+	std::vector<unsigned> eliminatedAt;
+	std::vector<Elimination> eliminations;
+
+	bool modelValid;
+	std::vector<signed char> model;
+
+	std::uint64_t numClausesIn;
+	std::uint64_t numLiteralsIn;
+	std::uint64_t numClausesOut;
+	std::uint64_t numLiteralsOut;
+	std::uint64_t numTautologies;
+	std::uint64_t numSatisfied;
+	std::uint64_t numFalseLiterals;
+	std::uint64_t numUnits;
+	std::uint64_t numDuplicates;
+	std::uint64_t numSubsumed;
+	std::uint64_t numEliminated;
+	std::uint64_t numResolvents;
+	std::uint64_t numRestored;
+	double time;
+
+	void init() {
+		clause.clear();
+		assumptions.clear();
+		pending.clear();
+		inconsistent = false;
+		clauses.clear();
+		removed.clear();
+		watches.clear();
+		assignment.clear();
+		frozen.clear();
+		marked.clear();
+		eliminatedAt.clear();
+		eliminations.clear();
+		modelValid = false;
+		model.clear();
+
+		numClausesIn = 0;
+		numLiteralsIn = 0;
+		numClausesOut = 0;
+		numLiteralsOut = 0;
+		numTautologies = 0;
+		numSatisfied = 0;
+		numFalseLiterals = 0;
+		numUnits = 0;
+		numDuplicates = 0;
+		numSubsumed = 0;
+		numEliminated = 0;
+		numResolvents = 0;
+		numRestored = 0;
+		time = 0;
+	}
+
+	static unsigned code(int lit) {
+		return 2 * static_cast<unsigned>(std::abs(lit)) + (lit < 0);
+	}
+
+	void ensureVar(int var) {
+		unsigned size = static_cast<unsigned>(var) + 1;
+		if (size > assignment.size()) {
+			assignment.resize(size, 0);
+			frozen.resize(size, false);
+			marked.resize(2 * size, false);
+			watches.resize(2 * size);
+			eliminatedAt.resize(size, 0);
+			model.resize(size, 0);
+		}
+	}
+
+	bool isKnown(int var) {
+		return static_cast<unsigned>(var) < assignment.size()
+			&& assignment[var] == 0
+			&& eliminatedAt[var] == 0;
+	}
+
+	signed char assigned(int lit) {
+		signed char v = assignment[std::abs(lit)];
+		return (lit < 0) ? -v : v;
+	}
+
+	void addPending(std::vector<int> lits) {
+		for (int lit: lits) {
+			ensureVar(std::abs(lit));
+		}
+		for (int lit: lits) {
+			restore(std::abs(lit));
+		}
+
+		std::sort(lits.begin(), lits.end(), [](int a, int b){
+			return std::abs(a) < std::abs(b)
+				|| (std::abs(a) == std::abs(b) && a < b);
+		});
+		lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+		for (unsigned i = 1; i < lits.size(); i++) {
+			if (lits[i] == -lits[i - 1]) {
+				numTautologies += 1;
+				return;
+			}
+		}
+		pending.push_back(std::move(lits));
+	}
+
+	/**
+	 * Add the clauses removed by the elimination of var again.
+	 */
+	void restore(int var) {
+		unsigned index = eliminatedAt[var];
+		if (index == 0) {
+			return;
+		}
+		eliminatedAt[var] = 0;
+		numRestored += 1;
+
+		Elimination& elimination = eliminations[index - 1];
+		elimination.active = false;
+		std::vector<std::vector<int>> restored;
+		restored.swap(elimination.clauses);
+		for (std::vector<int>& lits: restored) {
+			addPending(std::move(lits));
+		}
+	}
+
+	void simplify() {
+		if (inconsistent) {
+			pending.clear();
+			return;
+		}
+
+		propagate();
+		if (inconsistent) {
+			pending.clear();
+			solver->add(0);
+			return;
+		}
+
+		unsigned first = clauses.size();
+		subsume();
+		if (eliminate) {
+			eliminateVariables(first);
+		}
+
+		for (unsigned i = first; i < clauses.size(); i++) {
+			if (!removed[i]) {
+				forward(clauses[i]);
+			}
+		}
+	}
+
+	/**
+	 * Apply the known units to the buffered clauses until no new unit is
+	 * found. New units are given to the solver directly.
+	 */
+	void propagate() {
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			std::vector<std::vector<int>> next;
+			next.reserve(pending.size());
+			for (std::vector<int>& lits: pending) {
+				bool satisfied = false;
+				std::vector<int> kept;
+				kept.reserve(lits.size());
+				for (int lit: lits) {
+					signed char v = assigned(lit);
+					if (v > 0) {
+						satisfied = true;
+						break;
+					} else if (v == 0) {
+						kept.push_back(lit);
+					}
+				}
+
+				if (satisfied) {
+					numSatisfied += 1;
+				} else if (kept.empty()) {
+					inconsistent = true;
+					return;
+				} else if (kept.size() == 1) {
+					numFalseLiterals += lits.size() - 1;
+					numUnits += 1;
+					int unit = kept[0];
+					assignment[std::abs(unit)] = (unit > 0) ? 1 : -1;
+					forward(kept);
+					changed = true;
+				} else {
+					numFalseLiterals += lits.size() - kept.size();
+					next.push_back(std::move(kept));
+				}
+			}
+			pending.swap(next);
+		}
+	}
+
+	/**
+	 * Move the buffered clauses into the clause database, shortest first,
+	 * dropping each clause which contains a clause of the database.
+	 */
+	void subsume() {
+		std::stable_sort(pending.begin(), pending.end(),
+			[](const std::vector<int>& a, const std::vector<int>& b){
+				return a.size() < b.size();
+			});
+
+		for (std::vector<int>& lits: pending) {
+			for (int lit: lits) {
+				marked[code(lit)] = true;
+			}
+
+			bool subsumed = false;
+			bool duplicate = false;
+			for (unsigned i = 0; i < lits.size() && !subsumed; i++) {
+				for (unsigned index: watches[code(lits[i])]) {
+					const std::vector<int>& other = clauses[index];
+					if (removed[index] || other.size() > lits.size()) {
+						continue;
+					}
+					subsumed = std::all_of(other.begin(), other.end(),
+						[this](int lit){return marked[code(lit)];});
+					if (subsumed) {
+						duplicate = (other.size() == lits.size());
+						break;
+					}
+				}
+			}
+
+			for (int lit: lits) {
+				marked[code(lit)] = false;
+			}
+
+			if (duplicate) {
+				numDuplicates += 1;
+			} else if (subsumed) {
+				numSubsumed += 1;
+			} else {
+				store(std::move(lits));
+			}
+		}
+		pending.clear();
+	}
+
+	unsigned store(std::vector<int> lits) {
+		unsigned index = clauses.size();
+		watches[code(lits[0])].push_back(index);
+		clauses.push_back(std::move(lits));
+		removed.push_back(false);
+		return index;
+	}
+
+	/**
+	 * Eliminate variables which only occur in clauses from index first on,
+	 * if this does not increase the number of clauses.
+	 */
+	void eliminateVariables(unsigned first) {
+		std::vector<std::vector<unsigned>> occurs(watches.size());
+		for (unsigned i = first; i < clauses.size(); i++) {
+			for (int lit: clauses[i]) {
+				occurs[code(lit)].push_back(i);
+			}
+		}
+
+		std::vector<int> candidates;
+		for (int var = 1; var < static_cast<int>(assignment.size()); var++) {
+			unsigned numPositive = occurs[code(var)].size();
+			unsigned numNegative = occurs[code(-var)].size();
+			if (!frozen[var] && assignment[var] == 0
+					&& numPositive + numNegative > 0
+					&& numPositive <= maxOccurrences
+					&& numNegative <= maxOccurrences) {
+				candidates.push_back(var);
+			}
+		}
+		std::stable_sort(candidates.begin(), candidates.end(),
+			[&occurs](int a, int b){
+				return occurs[code(a)].size() + occurs[code(-a)].size()
+					< occurs[code(b)].size() + occurs[code(-b)].size();
+			});
+
+		for (int var: candidates) {
+			std::vector<unsigned> positive = alive(occurs[code(var)]);
+			std::vector<unsigned> negative = alive(occurs[code(-var)]);
+			if (positive.size() > maxOccurrences
+					|| negative.size() > maxOccurrences) {
+				continue;
+			}
+
+			std::vector<std::vector<int>> resolvents;
+			bool bounded = true;
+			for (unsigned i = 0; i < positive.size() && bounded; i++) {
+				for (unsigned j = 0; j < negative.size() && bounded; j++) {
+					std::vector<int> resolvent;
+					if (resolve(clauses[positive[i]], clauses[negative[j]],
+							var, resolvent)) {
+						resolvents.push_back(std::move(resolvent));
+						bounded = resolvents.size()
+								<= positive.size() + negative.size()
+							&& resolvents.back().size() <= maxResolventLength;
+					}
+				}
+			}
+			if (!bounded) {
+				continue;
+			}
+
+			numEliminated += 1;
+			eliminations.push_back({var, true, {}});
+			eliminatedAt[var] = eliminations.size();
+			for (unsigned index: positive) {
+				removed[index] = true;
+				eliminations.back().clauses.push_back(std::move(clauses[index]));
+			}
+			for (unsigned index: negative) {
+				removed[index] = true;
+				eliminations.back().clauses.push_back(std::move(clauses[index]));
+			}
+
+			for (std::vector<int>& resolvent: resolvents) {
+				numResolvents += 1;
+				unsigned index = store(std::move(resolvent));
+				for (int lit: clauses[index]) {
+					occurs[code(lit)].push_back(index);
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned> alive(const std::vector<unsigned>& indices) {
+		std::vector<unsigned> result;
+		for (unsigned index: indices) {
+			if (!removed[index]) {
+				result.push_back(index);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Resolve the sorted clauses a and b on var, returns false if the
+	 * resolvent is a tautology.
+	 */
+	bool resolve(const std::vector<int>& a, const std::vector<int>& b, int var,
+			std::vector<int>& resolvent) {
+		for (int lit: a) {
+			if (std::abs(lit) != var) {
+				resolvent.push_back(lit);
+				marked[code(lit)] = true;
+			}
+		}
+		bool tautology = false;
+		for (int lit: b) {
+			if (std::abs(lit) == var || marked[code(lit)]) {
+				continue;
+			}
+			if (marked[code(-lit)]) {
+				tautology = true;
+				break;
+			}
+			resolvent.push_back(lit);
+		}
+		for (int lit: a) {
+			marked[code(lit)] = false;
+		}
+
+		std::sort(resolvent.begin(), resolvent.end(), [](int x, int y){
+			return std::abs(x) < std::abs(y)
+				|| (std::abs(x) == std::abs(y) && x < y);
+		});
+		return !tautology;
+	}
+
+	void forward(const std::vector<int>& lits) {
+		numClausesOut += 1;
+		numLiteralsOut += lits.size();
+		for (int lit: lits) {
+			frozen[std::abs(lit)] = true;
+			solver->add(lit);
+		}
+		solver->add(0);
+	}
+
+	/**
+	 * Value of lit in the current model: 1 if true, -1 if false. Variables
+	 * which are unknown to the solver are false.
+	 */
+	signed char value(int lit) {
+		int var = std::abs(lit);
+		signed char result = -1;
+		if (static_cast<unsigned>(var) < assignment.size()) {
+			if (assignment[var] != 0) {
+				result = assignment[var];
+			} else if (model[var] != 0) {
+				result = model[var];
+			} else if (frozen[var]) {
+				result = (solver->val(var) > 0) ? 1 : -1;
+			}
+		}
+		return (lit < 0) ? -result : result;
+	}
+
+	/**
+	 * Extend the model of the solver to the eliminated variables, in
+	 * reverse order of elimination.
+	 */
+	void reconstruct() {
+		std::fill(model.begin(), model.end(), 0);
+		for (auto it = eliminations.rbegin(); it != eliminations.rend(); ++it) {
+			if (!it->active) {
+				continue;
+			}
+
+			int var = it->var;
+			signed char result = -1;
+			for (const std::vector<int>& lits: it->clauses) {
+				bool needed = false;
+				bool satisfied = false;
+				for (int lit: lits) {
+					if (lit == var) {
+						needed = true;
+					} else if (lit != -var && value(lit) > 0) {
+						satisfied = true;
+						break;
+					}
+				}
+				if (needed && !satisfied) {
+					result = 1;
+					break;
+				}
+			}
+			model[var] = result;
+		}
+		modelValid = true;
+	}
+
+	void updateLoggedData() {
+		auto& stats = SolveMetrics::current().result("simplification");
+
+		stats["numClausesIn"] = numClausesIn;
+		stats["numLiteralsIn"] = numLiteralsIn;
+		stats["numClausesOut"] = numClausesOut;
+		stats["numLiteralsOut"] = numLiteralsOut;
+		stats["numTautologies"] = numTautologies;
+		stats["numSatisfied"] = numSatisfied;
+		stats["numFalseLiterals"] = numFalseLiterals;
+		stats["numUnits"] = numUnits;
+		stats["numDuplicates"] = numDuplicates;
+		stats["numSubsumed"] = numSubsumed;
+		stats["numEliminated"] = numEliminated;
+		stats["numResolvents"] = numResolvents;
+		stats["numRestored"] = numRestored;
+		stats["time"] = time;
+	}
+};
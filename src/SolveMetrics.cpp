@@ -0,0 +1,56 @@
+#include "SolveMetrics.h"
+
+#include <mutex>
+#include <utility>
+
+namespace {
+	thread_local SolveMetrics* bound = nullptr;
+
+	std::mutex mergeMutex;
+}
+
+SolveMetrics& SolveMetrics::current() {
+	if (bound == nullptr) {
+		thread_local SolveMetrics unbound;
+		return unbound;
+	}
+	return *bound;
+}
+
+SolveMetrics::Scope::Scope(SolveMetrics& metrics):
+	previous(bound)
+{
+	bound = &metrics;
+}
+
+SolveMetrics::Scope::~Scope() {
+	bound = previous;
+}
+
+void SolveMetrics::mergeInto(json& result) {
+	std::lock_guard<std::mutex> lock(mergeMutex);
+
+	if (!solveEntries.empty()) {
+		json& solves = result["solves"];
+		if (!solves.is_array()) {
+			solves = json::array();
+		}
+		for (json& solve: solveEntries) {
+			solves.push_back(std::move(solve));
+		}
+	}
+
+	for (auto& named: results) {
+		json& target = result[named.first];
+		if (!named.second.is_object() || !target.is_object()) {
+			target = std::move(named.second);
+			continue;
+		}
+		for (auto it = named.second.begin(); it != named.second.end(); ++it) {
+			target[it.key()] = std::move(it.value());
+		}
+	}
+
+	solveEntries.clear();
+	results.clear();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "json.hpp"
+
+#include <deque>
+#include <map>
+#include <string>
+
+/**
+ * Results of one encoder and solver stack: an entry per makespan in
+ * solves and named result objects, i.e. learnedClauseEval. The encoders and
+ * decorators find the metrics of their stack through current(), which is
+ * bound per thread, so stacks in different threads record without locks.
+ * Once the stack is done, the metrics are merged into the results of carj.
+ *
+ * Entries of solves keep their address while new ones are added, so a
+ * timer can hold a reference to the entry of the running makespan.
+ */
+class SolveMetrics {
+public:
+	typedef nlohmann::json json;
+
+	/**
+	 * The metrics bound to the calling thread. A thread without bound
+	 * metrics writes to its own ones, which are never merged.
+	 */
+	static SolveMetrics& current();
+
+	/**
+	 * Binds metrics to the calling thread for the lifetime of the scope.
+	 */
+	class Scope {
+	public:
+		Scope(SolveMetrics& metrics);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		SolveMetrics* previous;
+	};
+
+	std::deque<json>& solves() {
+		return solveEntries;
+	}
+
+	/**
+	 * The result object with the given name, i.e. "restarts".
+	 */
+	json& result(const std::string& name) {
+		return results[name];
+	}
+
+	/**
+	 * Append the solves to result["solves"], set the fields of the named
+	 * results in result[name] and clear the metrics. Merges of different
+	 * threads are serialized, other writers of result are not.
+	 */
+	void mergeInto(json& result);
+
+private:
+	std::deque<json> solveEntries;
+	std::map<std::string, json> results;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ClauseFingerprint.h"
+#include "CountingSolver.h"
+#include "LearnedClauseEvaluationDecorator.h"
+
+#include "ipasir/ipasir_cpp.h"
+#include "ipasir/randomized_ipasir.h"
+
+/**
+ * Solver stacks whose layers are composed at compile time.
+ * SolverStack<Backend, Outer, ..., Inner>::type is
+ * Outer<...<Inner<Backend>>>, where each layer holds the next one by value.
+ * Only the call of the encoder into the outermost layer is virtual, the
+ * calls between the layers are resolved at compile time and can be inlined.
+ *
+ * The constructor arguments are passed down to the innermost layer, which
+ * takes any, i.e. the seed of the randomized layer.
+ */
+template<class Backend, template<class> class ... Layers>
+struct SolverStack;
+
+template<class Backend>
+struct SolverStack<Backend> {
+	typedef Backend type;
+};
+
+template<class Backend,
+	template<class> class Outer,
+	template<class> class ... Inner>
+struct SolverStack<Backend, Outer, Inner...> {
+	typedef Outer<typename SolverStack<Backend, Inner...>::type> type;
+};
+
+template<class Next>
+using RandomizedLayer = ipasir::BasicRandomizedSolver<Next>;
+
+template<class Next>
+using LearnedClauseEvaluationLayer = BasicLearnedClauseEvaluationDecorator<Next>;
+
+template<class Next>
+using FingerprintLayer = BasicFingerprintDecorator<Next>;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Stores sets of unsigned numbers and finds stored sets, which are a subset
+ * of a given set (unlimited branching tree). Each stored set is a path of
+ * its sorted elements, a query follows only edges which are elements of the
+ * query, so the cost depends on the stored prefixes of the query and not on
+ * the number of stored sets.
+ *
+ * Only minimal sets are kept: inserting a set which has a stored subset
+ * does nothing and inserting a set removes its stored supersets.
+ */
+class SubsetIndex {
+public:
+	SubsetIndex():
+		root(std::make_unique<Node>()),
+		numSets(0) {
+	}
+
+	/**
+	 * Returns false if a subset of set is already contained.
+	 */
+	bool insert(std::vector<unsigned> set) {
+		normalize(set);
+		if (containsSubsetOf(set)) {
+			return false;
+		}
+		removeSupersets(*root, set, 0);
+
+		Node* node = root.get();
+		for (unsigned element: set) {
+			std::unique_ptr<Node>& child = node->children[element];
+			if (!child) {
+				child = std::make_unique<Node>();
+			}
+			node = child.get();
+		}
+		node->isEnd = true;
+		numSets += 1;
+		return true;
+	}
+
+	bool containsSubsetOf(std::vector<unsigned> set) const {
+		normalize(set);
+		return containsSubsetOf(*root, set, 0);
+	}
+
+	unsigned size() const {
+		return numSets;
+	}
+
+	void clear() {
+		root = std::make_unique<Node>();
+		numSets = 0;
+	}
+
+private:
+	struct Node {
+		bool isEnd = false;
+		std::map<unsigned, std::unique_ptr<Node>> children;
+	};
+
+	std::unique_ptr<Node> root;
+	unsigned numSets;
+
+	static void normalize(std::vector<unsigned>& set) {
+		std::sort(set.begin(), set.end());
+		set.erase(std::unique(set.begin(), set.end()), set.end());
+	}
+
+	static bool containsSubsetOf(const Node& node,
+			const std::vector<unsigned>& set, unsigned i) {
+		if (node.isEnd) {
+			return true;
+		}
+		for (; i < set.size(); i++) {
+			auto it = node.children.find(set[i]);
+			if (it != node.children.end()
+					&& containsSubsetOf(*it->second, set, i + 1)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Remove all stored sets below node, which contain set[i..], returns
+	 * true if node became empty.
+	 */
+	bool removeSupersets(Node& node, const std::vector<unsigned>& set,
+			unsigned i) {
+		if (i == set.size()) {
+			numSets -= count(node);
+			node.isEnd = false;
+			node.children.clear();
+			return true;
+		}
+
+		for (auto it = node.children.begin(); it != node.children.end();) {
+			bool empty = false;
+			if (it->first < set[i]) {
+				empty = removeSupersets(*it->second, set, i);
+			} else if (it->first == set[i]) {
+				empty = removeSupersets(*it->second, set, i + 1);
+			} else {
+				break;
+			}
+
+			if (empty) {
+				it = node.children.erase(it);
+			} else {
+				++it;
+			}
+		}
+		return !node.isEnd && node.children.empty();
+	}
+
+	static unsigned count(const Node& node) {
+		unsigned result = node.isEnd ? 1 : 0;
+		for (auto& child: node.children) {
+			result += count(*child.second);
+		}
+		return result;
+	}
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "SatVariable.h"
+
+#include <string>
+
+#include "carj/logging.h"
+
+/**
+ * Numbering of the two dimensional variables (pigeon, hole), as solvers
+ * index their data structures by variable:
+ *  - pigeonMajor: the holes of a pigeon are consecutive
+ *  - holeMajor: the pigeons of a hole are consecutive
+ *  - interleaved: as pigeonMajor, but the pigeon hole variables and the
+ *    connectors of the 3SAT encodings share one block, so P(p, h) lies
+ *    between H(p, h) and H(p, h + 1); only for the 3SAT encodings
+ */
+enum class VariableLayout {
+	PIGEON_MAJOR,
+	HOLE_MAJOR,
+	INTERLEAVED
+};
+
+/**
+ * Returns false for an unknown name.
+ */
+inline bool variableLayoutFromName(const std::string& name,
+		VariableLayout& layout) {
+	if (name == "pigeonMajor") {
+		layout = VariableLayout::PIGEON_MAJOR;
+	} else if (name == "holeMajor") {
+		layout = VariableLayout::HOLE_MAJOR;
+	} else if (name == "interleaved") {
+		layout = VariableLayout::INTERLEAVED;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * The containers below are combined by virtual inheritance, so only the
+ * most derived class constructs VariableContainer. numInterleaved is the
+ * number of (pigeon, hole) variables of all combined containers, which
+ * share a block in the interleaved layout.
+ */
+class VariableContainer {
+public:
+	VariableContainer(
+			unsigned _numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR,
+			unsigned numInterleaved = 1):
+		numPigeons(_numPigeons),
+		allocator(layout == VariableLayout::HOLE_MAJOR ?
+			SatVariableAllocator::Layout::COLUMN_MAJOR :
+			SatVariableAllocator::Layout::ROW_MAJOR)
+	{
+		if (layout == VariableLayout::INTERLEAVED) {
+			if (numInterleaved < 2) {
+				LOG(FATAL) << "The interleaved layout needs the connectors "
+					"of the 3sat encodings.";
+			}
+			allocator.interleave({numPigeons, numPigeons}, numInterleaved);
+		}
+	}
+
+	virtual int pigeonInHole(unsigned pigeon, unsigned hole) = 0;
+
+	virtual SatVariableAllocator& getAllocator() {
+		return allocator;
+	}
+
+	virtual ~VariableContainer(){
+
+	}
+protected:
+	unsigned numPigeons;
+
+private:
+	SatVariableAllocator allocator;
+};
+
+class BasicVariableContainer: public virtual VariableContainer {
+public:
+	static constexpr unsigned numInterleaved = 1;
+
+	BasicVariableContainer(
+			unsigned numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR):
+		VariableContainer(numPigeons, layout, numInterleaved),
+		P(VariableContainer::getAllocator().newVariable(
+			numPigeons, numPigeons - 1)) {
+
+	}
+
+	virtual int pigeonInHole(unsigned pigeon, unsigned hole) {
+		return P(pigeon, hole);
+	}
+
+	virtual ~BasicVariableContainer(){
+
+	}
+
+private:
+	SatVariable<unsigned, unsigned> P;
+};
+
+class ExtendedVariableContainer: public virtual VariableContainer {
+public:
+	static constexpr unsigned numInterleaved = 1;
+
+	/**
+	 * The layout applies within each layer. The top layer holds the pigeon
+	 * hole variables of the formula and follows the lower ones, in the
+	 * interleaved layout it takes the shared block.
+	 */
+	ExtendedVariableContainer(
+			unsigned numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR):
+		VariableContainer(numPigeons, layout, numInterleaved),
+		lower(VariableContainer::getAllocator().newBlockedVariable(
+			numPigeons, numPigeons, numPigeons - 1)),
+		top(VariableContainer::getAllocator().newVariable(
+			numPigeons, numPigeons - 1))
+	{
+	}
+
+	virtual int pigeonInHole(unsigned pigeon, unsigned hole) {
+		return top(pigeon, hole);
+	}
+
+	virtual int pigeonInHole(unsigned layer, unsigned pigeon, unsigned hole) {
+		if (layer == numPigeons) {
+			return top(pigeon, hole);
+		}
+		return lower(layer, pigeon, hole);
+	}
+
+	virtual ~ExtendedVariableContainer(){
+
+	}
+private:
+	SatVariable<unsigned, unsigned, unsigned> lower;
+	SatVariable<unsigned, unsigned> top;
+};
+
+class VariableContainer3SAT: public virtual VariableContainer {
+public:
+	static constexpr unsigned numInterleaved = 1;
+
+	VariableContainer3SAT(
+			unsigned numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR):
+		VariableContainer(numPigeons, layout, numInterleaved),
+		H(getAllocator().newVariable(numPigeons, numPigeons))
+	{
+	}
+
+	virtual int connector(unsigned pigeon, unsigned hole) {
+		return H(pigeon, hole);
+	}
+
+	virtual ~VariableContainer3SAT(){
+
+	}
+private:
+	SatVariable<unsigned, unsigned> H;
+};
+
+class HelperVariableContainer: public virtual VariableContainer {
+public:
+	static constexpr unsigned numInterleaved = 0;
+
+	HelperVariableContainer(
+			unsigned numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR):
+		VariableContainer(numPigeons, layout, numInterleaved),
+		helperVar(getAllocator().newVariable(numPigeons))
+	{
+	}
+
+	virtual int helper(unsigned i) {
+		return helperVar(i);
+	}
+
+	virtual ~HelperVariableContainer(){
+
+	}
+
+private:
+	SatVariable<unsigned> helperVar;
+};
+
+template <class T1, class T2>
+class ContainerCombinator:
+		public virtual VariableContainer,
+		public virtual T1,
+		public virtual T2 {
+
+public:
+	ContainerCombinator(
+			unsigned numPigeons,
+			VariableLayout layout = VariableLayout::PIGEON_MAJOR):
+		VariableContainer(numPigeons, layout,
+			T1::numInterleaved + T2::numInterleaved),
+		T1(numPigeons, layout),
+		T2(numPigeons, layout)
+	{
+	}
+
+	virtual ~ContainerCombinator(){
+
+	}
+};
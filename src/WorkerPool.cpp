@@ -0,0 +1,268 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "carj/logging.h"
+
+WorkerPool::WorkerPool(unsigned numWorkers, Job _job, double _timeout,
+		std::size_t _memoryLimit):
+	job(_job),
+	timeout(_timeout),
+	memoryLimit(_memoryLimit),
+	workers(std::max(1u, numWorkers))
+{
+	for (Worker& worker: workers) {
+		spawn(worker);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	for (Worker& worker: workers) {
+		stop(worker, worker.job >= 0);
+	}
+}
+
+void WorkerPool::spawn(Worker& worker) {
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+		LOG(FATAL) << "socketpair failed: " << std::strerror(errno);
+	}
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		LOG(FATAL) << "fork failed: " << std::strerror(errno);
+	}
+
+	if (pid == 0) {
+		close(fds[0]);
+		for (Worker& other: workers) {
+			if (other.fd >= 0) {
+				close(other.fd);
+			}
+		}
+		serve(fds[1]);
+	}
+
+	close(fds[1]);
+	worker.pid = pid;
+	worker.fd = fds[0];
+	worker.job = -1;
+}
+
+void WorkerPool::stop(Worker& worker, bool kill) {
+	if (worker.pid < 0) {
+		return;
+	}
+	if (kill) {
+		::kill(worker.pid, SIGKILL);
+	}
+	// the worker exits when its socket is closed
+	close(worker.fd);
+	waitpid(worker.pid, nullptr, 0);
+	worker.pid = -1;
+	worker.fd = -1;
+	worker.job = -1;
+}
+
+std::string WorkerPool::waitStatus(Worker& worker) {
+	int status = 0;
+	waitpid(worker.pid, &status, 0);
+	close(worker.fd);
+	worker.pid = -1;
+	worker.fd = -1;
+
+	if (WIFSIGNALED(status)) {
+		return std::string("signal ") + strsignal(WTERMSIG(status));
+	} else if (WIFEXITED(status)) {
+		return std::string("exit ") + std::to_string(WEXITSTATUS(status));
+	}
+	return "unknown";
+}
+
+void WorkerPool::serve(int fd) {
+	// the output of the job would interleave with the result stream of the
+	// coordinator
+	int devNull = open("/dev/null", O_WRONLY);
+	if (devNull >= 0) {
+		dup2(devNull, STDOUT_FILENO);
+		close(devNull);
+	}
+	el::Loggers::reconfigureAllLoggers(el::ConfigurationType::Enabled, "false");
+
+	if (memoryLimit > 0) {
+		struct rlimit limit;
+		limit.rlim_cur = memoryLimit;
+		limit.rlim_max = memoryLimit;
+		setrlimit(RLIMIT_AS, &limit);
+	}
+
+	std::string message;
+	while (readMessage(fd, message)) {
+		json result;
+		try {
+			result["result"] = job(json::parse(message));
+			result["status"] = "ok";
+		} catch (std::bad_alloc&) {
+			result["status"] = "memout";
+		} catch (std::exception& e) {
+			result["status"] = "error";
+			result["what"] = e.what();
+		}
+
+		if (!writeMessage(fd, result.dump())) {
+			break;
+		}
+	}
+
+	// do not run destructors of the parent, i.e. writing carj.json
+	_exit(0);
+}
+
+void WorkerPool::run(const std::vector<json>& jobs,
+		std::function<void(const json& result)> onResult) {
+	unsigned nextJob = 0;
+	unsigned numFinished = 0;
+
+	auto finish = [&](Worker& worker, json result) {
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - worker.start;
+		result["job"] = worker.job;
+		if (result.count("worker") == 0) {
+			result["worker"] = worker.pid;
+		}
+		result["time"] = elapsed.count();
+		worker.job = -1;
+		numFinished += 1;
+		onResult(result);
+	};
+
+	while (numFinished < jobs.size()) {
+		for (Worker& worker: workers) {
+			if (worker.pid < 0) {
+				spawn(worker);
+			}
+			if (worker.job < 0 && nextJob < jobs.size()) {
+				worker.job = nextJob;
+				worker.start = std::chrono::steady_clock::now();
+				nextJob += 1;
+				if (!writeMessage(worker.fd, jobs[worker.job].dump())) {
+					json result;
+					result["status"] = "crashed";
+					result["worker"] = worker.pid;
+					result["what"] = waitStatus(worker);
+					finish(worker, result);
+				}
+			}
+		}
+
+		std::vector<pollfd> fds;
+		std::vector<Worker*> busy;
+		int wait = -1;
+		auto now = std::chrono::steady_clock::now();
+		for (Worker& worker: workers) {
+			if (worker.job >= 0) {
+				fds.push_back({worker.fd, POLLIN, 0});
+				busy.push_back(&worker);
+				if (timeout > 0) {
+					std::chrono::duration<double> left =
+						worker.start - now + std::chrono::duration<double>(timeout);
+					int ms = std::max(0, static_cast<int>(left.count() * 1000) + 1);
+					wait = (wait < 0) ? ms : std::min(wait, ms);
+				}
+			}
+		}
+		if (busy.empty()) {
+			continue;
+		}
+
+		int ready = poll(fds.data(), fds.size(), wait);
+		if (ready < 0 && errno != EINTR) {
+			LOG(FATAL) << "poll failed: " << std::strerror(errno);
+		}
+
+		now = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < busy.size(); i++) {
+			Worker& worker = *busy[i];
+			if (ready > 0 && fds[i].revents != 0) {
+				std::string message;
+				if (readMessage(worker.fd, message)) {
+					finish(worker, json::parse(message));
+				} else {
+					json result;
+					result["status"] = "crashed";
+					result["worker"] = worker.pid;
+					result["what"] = waitStatus(worker);
+					finish(worker, result);
+				}
+			} else if (timeout > 0 && now - worker.start
+					> std::chrono::duration<double>(timeout)) {
+				json result;
+				result["status"] = "timeout";
+				result["worker"] = worker.pid;
+				int job = worker.job;
+				stop(worker, true);
+				worker.job = job;
+				finish(worker, result);
+			}
+		}
+	}
+}
+
+bool WorkerPool::writeMessage(int fd, const std::string& message) {
+	std::uint32_t length = message.size();
+	std::string buffer(reinterpret_cast<char*>(&length), sizeof(length));
+	buffer += message;
+
+	std::size_t written = 0;
+	while (written < buffer.size()) {
+		ssize_t n = send(fd, buffer.data() + written, buffer.size() - written,
+			MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		written += n;
+	}
+	return true;
+}
+
+namespace {
+	bool readAll(int fd, char* buffer, std::size_t size) {
+		std::size_t done = 0;
+		while (done < size) {
+			ssize_t n = read(fd, buffer + done, size - done);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				return false;
+			}
+			done += n;
+		}
+		return true;
+	}
+}
+
+bool WorkerPool::readMessage(int fd, std::string& message) {
+	std::uint32_t length;
+	if (!readAll(fd, reinterpret_cast<char*>(&length), sizeof(length))) {
+		return false;
+	}
+	message.resize(length);
+	return length == 0 || readAll(fd, &message[0], length);
+}
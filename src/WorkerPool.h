@@ -0,0 +1,66 @@
+#pragma once
+
+#include "carj/carj.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * Runs jobs in forked worker processes, so a crashing or hanging job does
+ * not take down the others. Jobs and results are json objects, which are
+ * sent as length prefixed messages over a unix socket pair per worker.
+ *
+ * Each result contains the job index, the worker pid, the wall clock time
+ * and a status: "ok" with the "result" of the job, "timeout" if the job
+ * exceeded the time limit, "memout" if it ran out of memory, "error" for
+ * an exception and "crashed" if the worker died. Workers which time out or
+ * die are replaced by a new process.
+ *
+ * The pool forks, so it must be started before any other thread.
+ */
+class WorkerPool {
+public:
+	typedef nlohmann::json json;
+	typedef std::function<json(const json& job)> Job;
+
+	/**
+	 * @param timeout wall clock limit per job in seconds, 0 for none
+	 * @param memoryLimit address space limit per worker in bytes, 0 for none
+	 */
+	WorkerPool(unsigned numWorkers, Job job, double timeout = 0,
+		std::size_t memoryLimit = 0);
+
+	~WorkerPool();
+
+	/**
+	 * Run all jobs and call onResult in the order the jobs finish.
+	 */
+	void run(const std::vector<json>& jobs,
+		std::function<void(const json& result)> onResult);
+
+private:
+	struct Worker {
+		pid_t pid = -1;
+		int fd = -1;
+		int job = -1;
+		std::chrono::time_point<std::chrono::steady_clock> start;
+	};
+
+	Job job;
+	double timeout;
+	std::size_t memoryLimit;
+	std::vector<Worker> workers;
+
+	void spawn(Worker& worker);
+	void stop(Worker& worker, bool kill);
+	[[noreturn]] void serve(int fd);
+	std::string waitStatus(Worker& worker);
+
+	static bool writeMessage(int fd, const std::string& message);
+	static bool readMessage(int fd, std::string& message);
+};
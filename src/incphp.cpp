@@ -1,16 +1,35 @@
 #include "incphp.h"
 
 #include <array>
+#include <fstream>
 #include <iostream>
 #include <cmath>
+#include <map>
+#include <random>
 #include <set>
+#include <sstream>
+#include <thread>
 
-#include "SatVariable.h"
+#include "PHPEncoder.h"
 #include "LearnedClauseEvaluationDecorator.h"
+#include "CountingSolver.h"
+#include "ClauseFingerprint.h"
+#include "SimplifyingDecorator.h"
+#include "CubeAndConquer.h"
+#include "WorkerPool.h"
+#include "ERProof.h"
+#include "InstanceFamily.h"
+#include "EncodingCache.h"
+#include "LemmaStore.h"
+#include "StaticSolverStack.h"
+#include "RestartingSolver.h"
+#include "ProgressExporter.h"
+#include "SolveMetrics.h"
 
 #include "tclap/CmdLine.h"
 #include "carj/carj.h"
 #include "carj/ScopedTimer.h"
+#include "carj/AsyncLog.h"
 #include "ipasir/randomized_ipasir.h"
 #include "ipasir/ipasir_cpp.h"
 #include "ipasir/printer.h"
@@ -30,23 +49,16 @@ carj::CarjArg<TCLAP::SwitchArg, bool> addAssumed("A", "addAssumed",
 	"Add assumed clauses.", cmd, defaultIsFalse);
 carj::CarjArg<TCLAP::SwitchArg, bool> fixedUpperBound("u", "fixedUpperBound",
 	"Add upper bound as clauses.", cmd, defaultIsFalse);
-
-namespace CollectData {
-class MakespanAndTime {
-public:
-	MakespanAndTime(unsigned makespan) {
-		static auto& solves = carj::getCarj()
-			.data["/incphp/result/solves"_json_pointer];
-		solves.push_back({});
-		solves.back()["makespan"] = makespan;
-		LOG(INFO) << "makespan: " << makespan;
-
-		timer = std::make_unique<carj::ScopedTimer>(solves.back()["time"]);
-	}
-private:
-	std::unique_ptr<carj::ScopedTimer> timer;
-};
-}
+carj::CarjArg<TCLAP::SwitchArg, bool> coreReuse("", "coreReuse",
+	"In alternate mode, skip assumption sets which contain the failed "
+	"assumptions of an earlier solve.", cmd, defaultIsFalse);
+carj::CarjArg<TCLAP::SwitchArg, bool> lazyAtMostOne("", "lazyAtMostOne",
+	"Only add the at most one clauses which are violated by a model and "
+	"solve again.", cmd, defaultIsFalse);
+carj::TCarjArg<TCLAP::ValueArg, std::string> variableLayout("", "variableLayout",
+	"Numbering of the pigeon hole variables: pigeonMajor, holeMajor or "
+	"interleaved (with the connectors of the 3sat encoding).",
+	!neccessaryArgument, "pigeonMajor", "layout", cmd);
 
 class DimSpecFixedPigeons {
 private:
@@ -137,654 +149,743 @@ public:
 	}
 };
 
-class VariableContainer {
-public:
-	VariableContainer(unsigned _numPigeons):
-		numPigeons(_numPigeons),
-		allocator()
-	{
 
-	}
 
-	virtual int pigeonInHole(unsigned pigeon, unsigned hole) = 0;
+carj::TCarjArg<TCLAP::ValueArg, unsigned> numberOfPigeons("n", "numPigeons",
+	"Number of pigeons", !neccessaryArgument, 1, "natural number", cmd);
 
-	virtual SatVariableAllocator& getAllocator() {
-		return allocator;
-	}
+carj::CarjArg<TCLAP::SwitchArg, bool> dimspec("d", "dimspec", "Output dimspec.",
+	cmd, defaultIsFalse);
 
-	virtual ~VariableContainer(){
+carj::CarjArg<TCLAP::SwitchArg, bool> print("p", "print", "Output as cnf.",
+	cmd, defaultIsFalse);
 
-	}
-protected:
-	unsigned numPigeons;
+carj::CarjArg<TCLAP::SwitchArg, bool> extendedResolution("e", "extendedResolution",
+	"Add extended resolution formulas.", cmd, defaultIsFalse);
 
-private:
-	SatVariableAllocator allocator;
-};
+carj::CarjArg<TCLAP::SwitchArg, bool> incremental("i", "incremental",
+	"Solve formual incrementally.", cmd, defaultIsFalse);
 
-class BasicVariableContainer: public virtual VariableContainer {
-public:
-	BasicVariableContainer(unsigned numPigeons):
-		VariableContainer(numPigeons),
-		P(VariableContainer::getAllocator().newVariable(
-			numPigeons, numPigeons - 1)) {
+carj::CarjArg<TCLAP::SwitchArg, bool> alternate("a", "alternate",
+	"alternate mode", cmd, defaultIsFalse);
 
-	}
+carj::CarjArg<TCLAP::SwitchArg, bool> encoding3SAT("3", "3sat",
+	"Encode PHP in 3 SAT CNF.", cmd, defaultIsFalse);
 
-	virtual int pigeonInHole(unsigned pigeon, unsigned hole) {
-		return P(pigeon, hole);
-	}
+carj::CarjArg<TCLAP::SwitchArg, bool> record("r", "record",
+	"Record clause learning data.", cmd, defaultIsFalse);
 
-	virtual ~BasicVariableContainer(){
+carj::CarjArg<TCLAP::SwitchArg, bool> countOnly("c", "count",
+	"Only count the emitted formula, do not solve it.", cmd, defaultIsFalse);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> fingerprint("", "fingerprint",
+	"Record a hash of the emitted formula, which ignores the order of "
+	"clauses between two solve calls.", cmd, defaultIsFalse);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> simplify("", "simplify",
+	"Propagate units and remove subsumed clauses before they reach the "
+	"solver.", cmd, defaultIsFalse);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> simplifyBVE("", "simplifyBVE",
+	"Additionally eliminate variables, which are neither assumed nor part "
+	"of clauses given to the solver, implies --simplify.", cmd, defaultIsFalse);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> seed("", "seed",
+	"Seed for the randomized solver, 0 draws a random seed.",
+	!neccessaryArgument, 0, "natural number", cmd);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> keepVariables("", "keepVariables",
+	"Let the randomized solver shuffle only clauses and literals, so that the "
+	"solver sees the variable numbers of the encoder and --variableLayout "
+	"takes effect.", cmd, defaultIsFalse);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> cubeAndConquer("", "cubeAndConquer",
+	"Solve the complete formula in parallel, split into cubes on the "
+	"placement of pigeons.", cmd, defaultIsFalse);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> threads("", "threads",
+	"Number of worker threads for --cubeAndConquer, 0 uses all cores.",
+	!neccessaryArgument, 0, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, double> cubeTimeout("", "cubeTimeout",
+	"Seconds after which an unsolved cube is split further.",
+	!neccessaryArgument, 10, "seconds", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> cubeDepth("", "cubeDepth",
+	"Number of pigeons whose placement is fixed by the initial cubes.",
+	!neccessaryArgument, 1, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> workers("", "workers",
+	"Run the jobs given by --jobs in this many worker processes.",
+	!neccessaryArgument, 0, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> jobs("", "jobs",
+	"File with one json object of parameters per line, each line is a job.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> jobSeeds("", "jobSeeds",
+	"Run each job with the seeds 1 to jobSeeds, 0 keeps the seed of the job.",
+	!neccessaryArgument, 0, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, double> jobTimeout("", "jobTimeout",
+	"Wall clock limit per job in seconds, 0 for none.",
+	!neccessaryArgument, 0, "seconds", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> jobMemory("", "jobMemory",
+	"Memory limit per worker in MiB, 0 for none.",
+	!neccessaryArgument, 0, "MiB", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> results("", "results",
+	"File to write the results of --workers to as json lines, default is "
+	"stdout.", !neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> erProof("", "erProof",
+	"Write the extended resolution refutation of the direct encoding as "
+	"binary DRAT to this file, no solver is used.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> erCnf("", "erCnf",
+	"Write the formula refuted by --erProof to this file.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> checkProof("", "checkProof",
+	"Check the extended resolution refutation with the built in forward "
+	"checker.", cmd, defaultIsFalse);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> family("", "family",
+	"Solve an instance family instead of the pigeon hole principle: php, "
+	"sparsePHP, functionalPHP, ontoPHP, mutilatedChessboard, tseitin or "
+	"cliqueColoring. The size is given by --numPigeons.",
+	!neccessaryArgument, "", "name", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> familyParameter("", "familyParameter",
+	"Degree of sparsePHP and tseitin, clique size of cliqueColoring, 0 for "
+	"the default.", !neccessaryArgument, 0, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> encodingCache("", "encodingCache",
+	"Directory of cached encodings. The encoding is replayed from the cache "
+	"if it was generated before and stored otherwise.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> lemmaStore("", "lemmaStore",
+	"Directory of learned clauses of earlier runs. The lemmas of the same "
+	"encoding are added at the start and the short clauses learned by this "
+	"run are added to them at the end.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> lemmaLength("", "lemmaLength",
+	"Maximal length of the clauses kept in the --lemmaStore.",
+	!neccessaryArgument, 3, "natural number", cmd);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> virtualStack("", "virtualStack",
+	"Always assemble the solver stack from virtual decorators, instead of "
+	"using the stacks composed at compile time.", cmd, defaultIsFalse);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> asyncLog("", "asyncLog",
+	"Write log messages from a background thread.", cmd, defaultIsFalse);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> decisionOrder("", "decisionOrder",
+	"Let the solver branch on the pigeon hole variables in this order: "
+	"holeMajor, pigeonMajor or, for the 3sat encoding, connectorFirst. "
+	"Needs a solver with the extended ipasir interface.",
+	!neccessaryArgument, "", "order", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, double> restartBudget("", "restartBudget",
+	"Seconds of the first attempt of each solve. An attempt which runs out "
+	"of time is repeated with a new permutation of the formula, the budgets "
+	"follow the Luby sequence. 0 disables restarts.",
+	!neccessaryArgument, 0, "seconds", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> encodeThreads("", "encodeThreads",
+	"Number of threads which generate the clauses of the encoding, 0 uses "
+	"all cores. The formula is the same for any number of threads.",
+	!neccessaryArgument, 1, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> learnWorkers("", "learnWorkers",
+	"Number of processes which solve the queries of each step of "
+	"--extendedResolution --incremental, 0 uses all cores. With more than "
+	"one, the workers are forked from the encoded solver and the clauses "
+	"they prove are added to it.",
+	!neccessaryArgument, 1, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, double> learnTimeout("", "learnTimeout",
+	"A worker of --learnWorkers which answers no query for this many "
+	"seconds is killed and its queries are solved in the main process. "
+	"0 waits without a limit.",
+	!neccessaryArgument, 60, "seconds", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> schedule("", "schedule",
+	"Which makespans are solved in incremental mode, the holes of skipped "
+	"makespans are still added. One of linear, exponential, skip (every "
+	"scheduleStride-th makespan) or binary (binary search).",
+	!neccessaryArgument, "linear", "schedule", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, unsigned> scheduleStride("", "scheduleStride",
+	"Distance of the solved makespans for --schedule skip.",
+	!neccessaryArgument, 2, "natural number", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> progress("", "progress",
+	"Write the current makespan, solve time, number of solves and learned "
+	"clauses and the memory usage to this file while running.",
+	!neccessaryArgument, "", "path", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, double> progressInterval("", "progressInterval",
+	"Seconds between two updates of the --progress file.",
+	!neccessaryArgument, 5, "seconds", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, std::string> progressFormat("", "progressFormat",
+	"Format of the --progress file: json or prometheus.",
+	!neccessaryArgument, "json", "format", cmd);
+
+carj::TCarjArg<TCLAP::ValueArg, int> progressLearnLength("", "progressLearnLength",
+	"Learned clauses up to this length are counted for --progress.",
+	!neccessaryArgument, 10, "natural number", cmd);
+
+carj::CarjArg<TCLAP::SwitchArg, bool> learnThread("", "learnThread",
+	"Pass learned clauses to the decorators on a separate thread while the "
+	"solver is running.", cmd, defaultIsFalse);
+
+/**
+ * Writes the --progress file, if it is set.
+ */
+std::unique_ptr<ProgressExporter> progressExporter;
+
+ipasir::VariableNumbering variableNumbering() {
+	return keepVariables.getValue() ?
+		ipasir::VariableNumbering::Kept : ipasir::VariableNumbering::Shuffled;
+}
 
+/**
+ * The common solver stacks, composed at compile time. Returns nullptr if the
+ * selected combination is only available as stack of virtual decorators.
+ */
+std::unique_ptr<ipasir::Ipasir> createStaticSolver() {
+	if (virtualStack.getValue() || print.getValue() || simplify.getValue()
+			|| simplifyBVE.getValue() || restartBudget.getValue() > 0
+			|| progressExporter) {
+		return nullptr;
+	}
+
+	if (countOnly.getValue()) {
+		if (fingerprint.getValue()) {
+			return std::make_unique<
+				SolverStack<CountingSolver, FingerprintLayer>::type>();
+		}
+		return nullptr;
+	}
+
+	unsigned solverSeed = seed.getValue();
+	if (solverSeed == 0) {
+		solverSeed = std::random_device()();
+	}
+
+	if (record.getValue() && fingerprint.getValue()) {
+		return std::make_unique<SolverStack<ipasir::Solver, FingerprintLayer,
+			LearnedClauseEvaluationLayer, RandomizedLayer>::type>(solverSeed,
+			variableNumbering(), learnThread.getValue());
+	} else if (record.getValue()) {
+		return std::make_unique<SolverStack<ipasir::Solver,
+			LearnedClauseEvaluationLayer, RandomizedLayer>::type>(solverSeed,
+			variableNumbering(), learnThread.getValue());
+	} else if (fingerprint.getValue()) {
+		return std::make_unique<SolverStack<ipasir::Solver, FingerprintLayer,
+			RandomizedLayer>::type>(solverSeed, variableNumbering(),
+			learnThread.getValue());
+	} else {
+		return std::make_unique<SolverStack<ipasir::Solver,
+			RandomizedLayer>::type>(solverSeed, variableNumbering(),
+			learnThread.getValue());
 	}
+}
 
-private:
-	SatVariable<unsigned, unsigned> P;
-};
-
-class ExtendedVariableContainer: public virtual VariableContainer {
-public:
-	ExtendedVariableContainer(unsigned numPigeons):
-		VariableContainer(numPigeons),
-		P(VariableContainer::getAllocator().newVariable(
-			numPigeons + 1, numPigeons, numPigeons - 1)) {
-
-	}
-	virtual int pigeonInHole(unsigned pigeon, unsigned hole) {
-		return P(numPigeons, pigeon, hole);
+std::unique_ptr<ipasir::Ipasir> createSolver() {
+	std::unique_ptr<ipasir::Ipasir> solver = createStaticSolver();
+	if (solver) {
+		return solver;
 	}
 
-	virtual int pigeonInHole(unsigned layer, unsigned pigeon, unsigned hole) {
-		return P(layer, pigeon, hole);
+	if (countOnly.getValue()) {
+		// no randomization, only the encoder is measured
+		solver = std::make_unique<CountingSolver>();
+	} else {
+		if (print.getValue()) {
+			solver = std::make_unique<ipasir::Printer>();
+		} else {
+			solver = std::make_unique<ipasir::Solver>(learnThread.getValue());
+		}
+		if (seed.getValue() != 0) {
+			solver = std::make_unique<ipasir::RandomizedSolver>(
+				seed.getValue(), std::move(solver), variableNumbering());
+		} else {
+			solver = std::make_unique<ipasir::RandomizedSolver>(
+				std::move(solver), variableNumbering());
+		}
+		if (restartBudget.getValue() > 0) {
+			solver = std::make_unique<RestartingSolver>(
+				std::move(solver), restartBudget.getValue());
+		}
+		if (progressExporter) {
+			solver = std::make_unique<ProgressDecorator>(std::move(solver),
+				progressExporter.get(), progressLearnLength.getValue());
+		}
+		if (record.getValue()) {
+			solver = std::make_unique<LearnedClauseEvaluationDecorator>(std::move(solver));
+		}
 	}
 
-	virtual ~ExtendedVariableContainer(){
-
+	if (simplify.getValue() || simplifyBVE.getValue()) {
+		solver = std::make_unique<SimplifyingDecorator>(
+			std::move(solver), simplifyBVE.getValue());
 	}
-private:
-	SatVariable<unsigned, unsigned, unsigned> P;
-};
 
-class VariableContainer3SAT: public virtual VariableContainer {
-public:
-	VariableContainer3SAT(unsigned numPigeons):
-		VariableContainer(numPigeons),
-		H(getAllocator().newVariable(numPigeons, numPigeons))
-	{
+	if (fingerprint.getValue()) {
+		solver = std::make_unique<FingerprintDecorator>(std::move(solver));
 	}
+	return solver;
+}
 
-	virtual int connector(unsigned pigeon, unsigned hole) {
-		return H(pigeon, hole);
+void solveFamily(std::unique_ptr<ipasir::Ipasir> solver) {
+	auto it = instanceFamilies().find(family.getValue());
+	if (it == instanceFamilies().end()) {
+		LOG(FATAL) << "Unknown instance family '" << family.getValue() << "'.";
 	}
 
-	virtual ~VariableContainer3SAT(){
+	std::unique_ptr<InstanceFamily> instance = it->second(std::move(solver),
+		numberOfPigeons.getValue(), familyParameter.getValue());
+	LOG(INFO) << "Instance family " << it->first << " with "
+		<< instance->getNumSteps() << " steps and "
+		<< instance->numberOfVariables() << " variables.";
 
-	}
-private:
-	SatVariable<unsigned, unsigned> H;
-};
+	auto& result = SolveMetrics::current().result("family");
+	result["name"] = it->first;
+	instance->solve(incremental.getValue());
+}
 
-class HelperVariableContainer: public virtual VariableContainer {
-public:
-	HelperVariableContainer(unsigned numPigeons):
-		VariableContainer(numPigeons),
-		helperVar(getAllocator().newVariable(numPigeons))
-	{
-	}
+void configureEncoder(UniversalPHPEncoder& encoder) {
+	encoder.setEncodeThreads(encodeThreads.getValue());
 
-	virtual int helper(unsigned i) {
-		return helperVar(i);
+	MakespanSchedule makespans;
+	if (!MakespanSchedule::fromName(schedule.getValue(),
+			scheduleStride.getValue(), makespans)) {
+		LOG(FATAL) << "Unknown schedule '" << schedule.getValue() << "'.";
 	}
+	encoder.setSchedule(makespans);
 
-	virtual ~HelperVariableContainer(){
-
+	if (decisionOrder.getValue().empty()) {
+		return;
 	}
-
-private:
-	SatVariable<unsigned> helperVar;
-};
-
-template <class T1, class T2>
-class ContainerCombinator:
-		public virtual VariableContainer,
-		public virtual T1,
-		public virtual T2 {
-
-public:
-	ContainerCombinator(unsigned numPigeons):
-		VariableContainer(numPigeons),
-		T1(numPigeons),
-		T2(numPigeons)
-	{
+	if (!encoder.useDecisionOrder(decisionOrder.getValue())) {
+		LOG(FATAL) << "Unknown decision order '" << decisionOrder.getValue()
+			<< "' for this encoding.";
 	}
+	#ifndef USE_EXTENDED_IPASIR
+	LOG(WARNING) << "Built without USE_EXTENDED_IPASIR, the solver does not "
+		"ask for decision literals.";
+	#endif
 
-	virtual ~ContainerCombinator(){
+	auto& result = SolveMetrics::current().result("decisionOrder");
+	result["name"] = decisionOrder.getValue();
+}
 
+void encodePHP(std::unique_ptr<ipasir::Ipasir> solver) {
+	if (!family.getValue().empty()) {
+		solveFamily(std::move(solver));
+		return;
 	}
-};
 
-class UniversalPHPEncoder {
-public:
-	UniversalPHPEncoder(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		unsigned _numPigeons):
-
-		UniversalPHPEncoder(
-			std::move(_solver),
-			std::make_unique<BasicVariableContainer>(_numPigeons),
-			_numPigeons
-		)
-	{}
-
-	UniversalPHPEncoder(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		std::unique_ptr<VariableContainer> _var,
-		unsigned _numPigeons):
-			solver(std::move(_solver)),
-			var(std::move(_var)),
-			numPigeons(_numPigeons)
-	{
-		assert(numPigeons > 1);
-	}
-
-	virtual void addAtMostOnePigeonInHole(unsigned hole) {
-		for (unsigned pigeonA = 1; pigeonA < numPigeons; pigeonA++) {
-			for (unsigned pigeonB = 0; pigeonB < pigeonA; pigeonB++) {
-				solver->addClause({
-					-var->pigeonInHole(pigeonA, hole),
-					-var->pigeonInHole(pigeonB, hole)
-				});
+	if (encoding3SAT.getValue()) {
+		if (extendedResolution.getValue()) {
+			std::unique_ptr<ExtendedPHPEncoder3SAT> encoder =
+				std::make_unique<ExtendedPHPEncoder3SAT>(
+						std::move(solver),
+						numberOfPigeons.getValue());
+			configureEncoder(*encoder);
+			encoder->setLearnWorkers(learnWorkers.getValue());
+			encoder->setLearnTimeout(learnTimeout.getValue());
+			if (incremental.getValue()) {
+				encoder->solveIncremental();
+			} else {
+				encoder->solve();
 			}
-		}
-	}
-
-	virtual void addAtLeastOneHolePerPigeon(
-			unsigned numHoles,
-			unsigned activationLiteral = 0) {
-
-		for (unsigned pigeon = 0; pigeon < numPigeons; pigeon++) {
-			for (unsigned hole = 0; hole < numHoles; hole++) {
-				solver->add(var->pigeonInHole(pigeon, hole));
+		} else {
+			std::unique_ptr<PHPEncoder3SAT> encoder;
+			if (alternate.getValue()) {
+				encoder = std::make_unique<AlternatePHPEncoder3SAT>(
+					std::move(solver),
+					numberOfPigeons.getValue());
+			} else {
+				encoder = std::make_unique<PHPEncoder3SAT>(
+						std::move(solver),
+						numberOfPigeons.getValue());
 			}
-			if (activationLiteral != 0) {
-				solver->add(activationLiteral);
+
+			configureEncoder(*encoder);
+			if (incremental.getValue()) {
+				encoder->solveIncremental();
+			} else {
+				encoder->solve();
 			}
-			solver->add(0);
 		}
-	}
-
-	virtual void solve(){
-		unsigned numHoles = numPigeons - 1;
-
-		addAtLeastOneHolePerPigeon(numHoles);
-		for (unsigned hole = 0; hole < numHoles; hole++) {
-			addAtMostOnePigeonInHole(hole);
+	} else {
+		if (extendedResolution.getValue()) {
+			LOG(FATAL) << "Unsupported Option";
 		}
-		bool solved = (solver->solve() == ipasir::SolveResult::SAT);
-		assert(!solved);
-	}
-
-	virtual VariableContainer* getVar() {
-		return var.get();
-	}
-
-	virtual ~UniversalPHPEncoder(){
 
+		if (incremental.getValue()) {
+			SimpleIncrementalPHPEncoder encoder(
+				std::move(solver),
+				numberOfPigeons.getValue());
+			configureEncoder(encoder);
+			encoder.solve();
+		} else {
+			UniversalPHPEncoder encoder(
+				std::move(solver),
+				numberOfPigeons.getValue());
+			configureEncoder(encoder);
+			encoder.solve();
+		}
 	}
+}
 
-protected:
-	std::unique_ptr<ipasir::Ipasir> solver;
-	std::unique_ptr<VariableContainer> var;
-	unsigned numPigeons;
-};
-
-typedef ContainerCombinator<HelperVariableContainer, BasicVariableContainer> hvc;
-
-class SimpleIncrementalPHPEncoder: public UniversalPHPEncoder {
-public:
-	SimpleIncrementalPHPEncoder(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		unsigned numPigeons):
-
-		UniversalPHPEncoder(
-				std::move(_solver),
-				std::make_unique<hvc>(numPigeons),
-				numPigeons
-			)
-		{
-			hvar = dynamic_cast<hvc*>(getVar());
-		}
+/**
+ * All parameters which change what the encoders pass to the solver.
+ */
+json encodingKey() {
+	json key;
+	key["version"] = encoderVersion;
+	key["numPigeons"] = numberOfPigeons.getValue();
+	key["3sat"] = encoding3SAT.getValue();
+	key["alternate"] = alternate.getValue();
+	key["extendedResolution"] = extendedResolution.getValue();
+	key["incremental"] = incremental.getValue();
+	key["variableLayout"] = variableLayout.getValue();
+	key["schedule"] = schedule.getValue();
+	key["scheduleStride"] = scheduleStride.getValue();
+	key["fixedUpperBound"] = fixedUpperBound.getValue();
+	key["addAssumed"] = addAssumed.getValue();
+	key["family"] = family.getValue();
+	key["familyParameter"] = familyParameter.getValue();
+	return key;
+}
 
-	virtual void solve(){
-		bool solved;
-		for (unsigned numHoles = 1; numHoles < numPigeons; numHoles++) {
-			addAtMostOnePigeonInHole(numHoles - 1);
-			addAtLeastOneHolePerPigeon(numHoles, hvar->helper(numHoles - 1));
-
-			{
-				CollectData::MakespanAndTime m(numHoles);
-				solver->assume(-hvar->helper(numHoles - 1));
-				solved = (solver->solve() == ipasir::SolveResult::SAT);
-				assert(!solved);
-			}
+void encodePHPCached(std::unique_ptr<ipasir::Ipasir> solver) {
+	if (encodingCache.getValue().empty()) {
+		encodePHP(std::move(solver));
+		return;
+	}
+	if (coreReuse.getValue() || lazyAtMostOne.getValue()
+			|| learnWorkers.getValue() != 1) {
+		// the forked workers would also write to the recording file
+		LOG(WARNING) << "The encoding depends on the answers of the solver "
+			"with --coreReuse, --lazyAtMostOne or --learnWorkers, it is not "
+			"cached.";
+		encodePHP(std::move(solver));
+		return;
+	}
+	if (!decisionOrder.getValue().empty()) {
+		LOG(WARNING) << "The decision order is set by the encoder, "
+			"--decisionOrder is not combined with --encodingCache.";
+		encodePHP(std::move(solver));
+		return;
+	}
+
+	EncodingCache cache(encodingCache.getValue(), encodingKey().dump());
+	if (cache.replay(*solver)) {
+		return;
+	}
+	encodePHP(cache.record(std::move(solver)));
+	cache.commit();
+}
 
-		}
+void encodePHPStored(std::unique_ptr<ipasir::Ipasir> solver) {
+	if (lemmaStore.getValue().empty()) {
+		encodePHPCached(std::move(solver));
+		return;
 	}
 
-	virtual ~SimpleIncrementalPHPEncoder(){}
-
-private:
-	hvc* hvar;
-};
-
-typedef ContainerCombinator<VariableContainer3SAT, BasicVariableContainer> svc;
+	// added below the recording of --encodingCache, so the lemmas are not
+	// part of the cached encoding
+	LemmaStore store(lemmaStore.getValue(), encodingKey().dump(),
+		lemmaLength.getValue());
+	solver = store.collect(std::move(solver));
+	store.load(*solver);
+	encodePHPCached(std::move(solver));
+	store.save();
+}
 
-class PHPEncoder3SAT: public UniversalPHPEncoder {
-public:
-	PHPEncoder3SAT(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		unsigned _numPigeons):
-		UniversalPHPEncoder(
-			std::move(_solver),
-			std::make_unique<svc>(_numPigeons),
-			_numPigeons
-		) {
+void solvePHP(std::unique_ptr<ipasir::Ipasir> solver) {
+	LOG(INFO) << "Using solver: " << solver->signature();
 
+	// the encoder and the decorators of this stack record to metrics, which
+	// only this thread writes to
+	SolveMetrics metrics;
+	{
+		SolveMetrics::Scope scope(metrics);
+		encodePHPStored(std::move(solver));
 	}
+	metrics.mergeInto(carj::getCarj().data["/incphp/result"_json_pointer]);
+}
 
-	PHPEncoder3SAT(
-			std::unique_ptr<ipasir::Ipasir> _solver,
-			std::unique_ptr<VariableContainer3SAT> _var,
-			unsigned _numPigeons):
-
-			UniversalPHPEncoder(
-				std::move(_solver),
-				std::move(_var),
-				_numPigeons
-				)
-		{
-
+std::unique_ptr<UniversalPHPEncoder> createEncoder(
+		std::unique_ptr<ipasir::Ipasir> solver) {
+	if (encoding3SAT.getValue()) {
+		if (extendedResolution.getValue()) {
+			return std::make_unique<ExtendedPHPEncoder3SAT>(
+				std::move(solver), numberOfPigeons.getValue());
+		} else {
+			// the alternate encoder only differs in the assumptions
+			return std::make_unique<PHPEncoder3SAT>(
+				std::move(solver), numberOfPigeons.getValue());
 		}
-
-	virtual void addLowerBorder() {
-		VariableContainer3SAT* var =
-			dynamic_cast<VariableContainer3SAT*>(getVar());
-
-		for (unsigned p = 0; p < numPigeons; p++) {
-			solver->addClause({ var->connector(p, 0)});
+	} else {
+		if (extendedResolution.getValue()) {
+			LOG(FATAL) << "Unsupported Option";
 		}
+		return std::make_unique<UniversalPHPEncoder>(
+			std::move(solver), numberOfPigeons.getValue());
 	}
+}
 
-	virtual void addBorders(bool forceUppberBound = false) {
-		addLowerBorder();
-		if (forceUppberBound || fixedUpperBound.getValue()) {
-			addUpperBorder();
-		}
+void solvePHPCubeAndConquer() {
+	if (!family.getValue().empty()) {
+		LOG(FATAL) << "--cubeAndConquer splits on the placement of pigeons, "
+			"--family is not supported.";
 	}
-
-	virtual void addHole(unsigned hole) {
-		VariableContainer3SAT* var =
-			dynamic_cast<VariableContainer3SAT*>(getVar());
-
-		for (unsigned p = 0; p < numPigeons; p++) {
-			solver->addClause({
-				-var->connector(p,hole),
-				 var->pigeonInHole(p, hole),
-				 var->connector(p, hole + 1)
-			});
-		}
-
-		addAtMostOnePigeonInHole(hole);
+	if (print.getValue() || countOnly.getValue() || record.getValue()
+			|| fingerprint.getValue() || simplify.getValue()
+			|| simplifyBVE.getValue()) {
+		LOG(WARNING) << "The workers of --cubeAndConquer use a plain solver, "
+			"options for the solver stack are ignored.";
+	}
+	if (incremental.getValue()) {
+		LOG(WARNING) << "--cubeAndConquer solves the complete formula, "
+			"--incremental is ignored.";
 	}
 
-	virtual void addUpperBorder() {
-		VariableContainer3SAT* var =
-			dynamic_cast<VariableContainer3SAT*>(getVar());
+	unsigned numThreads = threads.getValue();
+	if (numThreads == 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
 
-		for (unsigned p = 0; p < numPigeons; p++) {
-			solver->addClause({ -var->connector(p, numPigeons - 1)});
-		}
+	// draw the seeds here, the workers create their solvers concurrently
+	std::vector<unsigned> seeds;
+	std::random_device random;
+	for (unsigned i = 0; i < numThreads; i++) {
+		seeds.push_back(seed.getValue() != 0 ? seed.getValue() + i : random());
 	}
 
-	virtual void assumeAll(unsigned i) {
-		VariableContainer3SAT* var =
-			dynamic_cast<VariableContainer3SAT*>(getVar());
+	CubeAndConquer solver(
+		numberOfPigeons.getValue(),
+		numThreads,
+		cubeTimeout.getValue(),
+		cubeDepth.getValue(),
+		[&seeds](unsigned worker) {
+			return createEncoder(std::make_unique<ipasir::RandomizedSolver>(
+				seeds[worker], std::make_unique<ipasir::Solver>(),
+				variableNumbering()));
+		});
 
-		for (unsigned p = 0; p < numPigeons; p++) {
-			solver->assume(-var->connector(p, i));
-		}
+	LOG(INFO) << "Solving with " << numThreads << " threads.";
+	bool sat = solver.solve();
+	LOG(INFO) << (sat ? "SAT" : "UNSAT");
+}
 
-		bool solved = (solver->solve() == ipasir::SolveResult::SAT);
-		assert(!solved);
+/**
+ * Solve with the parameters of job, which are set on top of the current
+ * parameters, and return the collected results.
+ */
+json runJob(const json& job) {
+	json& parameter = *carj::getCarj().parameter;
+	json saved = parameter;
+	for (auto it = job.begin(); it != job.end(); ++it) {
+		parameter[it.key()] = it.value();
 	}
 
-	virtual void solve() {
-		solve(false);
-	}
+	// solvePHP merges the metrics of this job into the empty result
+	json& result = carj::getCarj().data["/incphp/result"_json_pointer];
+	result = json::object();
 
-	virtual void solveIncremental() {
-		solve(true);
-	}
+	solvePHP(createSolver());
 
-	virtual void solve(bool incremental){
-		addBorders();
-		for (unsigned numHoles = 1; numHoles < numPigeons; numHoles++) {
-			addHole(numHoles - 1);
-			if (incremental) {
-				CollectData::MakespanAndTime m(numHoles);
-				assumeAll(numHoles);
-			}
-		}
+	json collected = std::move(result);
+	result = json::object();
+	parameter = saved;
+	return collected;
+}
 
-		if (!incremental)
-		{
-			unsigned numHoles = numPigeons - 1;
-			CollectData::MakespanAndTime m(numHoles);
-			assumeAll(numHoles);
-		}
+void runWorkerPool() {
+	std::ifstream in(jobs.getValue());
+	if (!in) {
+		LOG(FATAL) << "Could not read jobs from '" << jobs.getValue() << "'.";
 	}
 
-	virtual ~PHPEncoder3SAT() {};
-};
-
-class AlternatePHPEncoder3SAT: public PHPEncoder3SAT {
-public:
-	AlternatePHPEncoder3SAT(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		unsigned _numPigeons):
-		PHPEncoder3SAT(
-			std::move(_solver),
-			std::make_unique<svc>(_numPigeons),
-			_numPigeons
-		) {
-
-	}
-
-	virtual void assumeAll(unsigned numHoles) {
-		VariableContainer3SAT* var =
-			dynamic_cast<VariableContainer3SAT*>(getVar());
-
-		unsigned n = numPigeons;
-		for (unsigned k = numPigeons; k >=numHoles + 1; k--) {
-			// std::cout << "n: " << n << " k: " << k << std::endl;
-
-			std::vector<bool> v(n);
-			std::fill(v.begin(), v.begin() + k, true);
-
-			do {
-				for (unsigned i = 0; i < n; ++i) {
-					if (v[i]) {
-						solver->assume(-var->connector(i, numHoles));
-						// std::cout << i << " ";
-					}
-				}
-				// std::cout << std::endl;
-				bool unsat = (solver->solve() == ipasir::SolveResult::UNSAT);
-				assert(unsat);
-
-				if (unsat && addAssumed.getValue()) {
-					for (unsigned i = 0; i < n; ++i) {
-						if (v[i]) {
-							solver->add(var->connector(i, numHoles));
-							// std::cout << i << " ";
-						}
-					}
-					solver->add(0);
-				}
-			} while (std::prev_permutation(v.begin(), v.end()));
+	std::vector<json> grid;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos) {
+			continue;
+		}
+		json job = json::parse(line);
+		if (jobSeeds.getValue() == 0) {
+			grid.push_back(job);
+		} else {
+			for (unsigned i = 1; i <= jobSeeds.getValue(); i++) {
+				job["seed"] = i;
+				grid.push_back(job);
+			}
 		}
 	}
-};
-
-typedef ContainerCombinator<ExtendedVariableContainer, VariableContainer3SAT> evc;
 
-class ExtendedPHPEncoder3SAT: public PHPEncoder3SAT {
-public:
-	ExtendedPHPEncoder3SAT(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		unsigned _numPigeons):
-
-		PHPEncoder3SAT(
-			std::move(_solver),
-			std::make_unique<evc>(_numPigeons),
-			_numPigeons
-		)
-	{
+	std::ofstream file;
+	if (!results.getValue().empty()) {
+		file.open(results.getValue());
 	}
+	std::ostream& out = results.getValue().empty() ? std::cout : file;
 
-	ExtendedPHPEncoder3SAT(
-		std::unique_ptr<ipasir::Ipasir> _solver,
-		std::unique_ptr<evc> _var,
-		unsigned _numPigeons):
-
-		PHPEncoder3SAT(
-			std::move(_solver),
-			std::move(_var),
-			_numPigeons
-			)
+	std::map<std::string, unsigned> numStatus;
 	{
-	}
-
-	virtual void addExtendedResolutionClauses(){
-		ExtendedVariableContainer* var =
-			dynamic_cast<ExtendedVariableContainer*>(getVar());
-
-		for (unsigned n = numPigeons; n > 2; n--) {
-			for (unsigned i = 0; i < n - 1; i++) {
-				for (unsigned j = 0; j < n - 2; j++) {
-					solver->addClause({
-						 var->pigeonInHole(n - 1, i, j),
-						-var->pigeonInHole(n, i, j)
-					});
-					solver->addClause({
-						 var->pigeonInHole(n - 1, i, j),
-						-var->pigeonInHole(n, i, n - 2),
-						-var->pigeonInHole(n, n - 1, j)
-					});
-					solver->addClause({
-						-var->pigeonInHole(n - 1, i, j),
-						 var->pigeonInHole(n, i, j),
-						 var->pigeonInHole(n, i, n - 2)
-					});
-					solver->addClause({
-						-var->pigeonInHole(n - 1, i, j),
-						 var->pigeonInHole(n, i, j),
-						 var->pigeonInHole(n, n - 1, j)
-					});
-				}
-			}
+		WorkerPool pool(workers.getValue(), runJob, jobTimeout.getValue(),
+			static_cast<std::size_t>(jobMemory.getValue()) << 20);
+		pool.run(grid, [&](const json& result) {
+			json line = result;
+			line["parameters"] = grid[result["job"].get<unsigned>()];
+			out << line.dump() << std::endl;
+			numStatus[result["status"].get<std::string>()] += 1;
+		});
+	}
+
+	auto& summary = SolveMetrics::current().result("workerPool");
+	summary["numJobs"] = grid.size();
+	summary["status"] = numStatus;
+	if (!results.getValue().empty()) {
+		for (auto& status: numStatus) {
+			LOG(INFO) << status.first << ": " << status.second;
 		}
 	}
+}
 
-	virtual void learnClauses(unsigned step){
-		unsigned sn = numPigeons;
-		ExtendedVariableContainer* var =
-			dynamic_cast<ExtendedVariableContainer*>(getVar());
-
-
-			// learn at most one
-			for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
-				for (unsigned p = 1; p < numPigeons - step; p++) {
-					for (unsigned j = 0; j < p; j++) {
-					//carj::ScopedTimer timer((*solves.rbegin())["time"]);
-					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << p << ", " << h << ")";
-					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << j << ", " << h << ")";
-
-					std::vector<int> clause({
-						-var->pigeonInHole(sn - step, p, h),
-						-var->pigeonInHole(sn - step, j, h)
-					});
-
-					for (int lit: clause) {
-						solver->assume(-lit);
-					}
-
-					std::set<int> clauseLiterals;
-					clauseLiterals.insert(clause.begin(),clause.end());
-
-					bool foundClause = false;
-					solver->set_learn(2, [&foundClause, &clauseLiterals](int* learned) {
-						std::set<int> learnedLiterals;
-						while(*learned != 0) {
-							learnedLiterals.insert(*learned);
-							learned++;
-						}
-
-						foundClause |= (learnedLiterals == clauseLiterals);
-					});
-
-					bool solved = (solver->solve() == ipasir::SolveResult::SAT);
-					assert(!solved);
+void emitERProof() {
+	if (numberOfPigeons.getValue() < 2) {
+		LOG(FATAL) << "At least two pigeons are required.";
+	}
 
-					solver->set_learn(0, [](int*){});
-					}
-				}
-			}
+	std::vector<ProofSink*> sinks;
 
-			// learn at least one
-			for (unsigned p = 1; p < numPigeons - step; p++) {
-				for (unsigned h = 0; h < numPigeons - 1 - step; h++) {
-					//carj::ScopedTimer timer((*solves.rbegin())["time"]);
-					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << p << ", " << h << ")";
-					//LOG(INFO) << "var->pigeonInHole(" << sn - step << ", " << j << ", " << h << ")";
-					solver->assume(-var->pigeonInHole(sn - step, p, h));
-				}
-				bool solved = (solver->solve() == ipasir::SolveResult::SAT);
-				assert(!solved);
-			}
+	std::ofstream cnfFile;
+	std::unique_ptr<DimacsWriter> cnf;
+	if (!erCnf.getValue().empty()) {
+		cnfFile.open(erCnf.getValue());
+		cnf = std::make_unique<DimacsWriter>(cnfFile);
+		sinks.push_back(cnf.get());
 	}
 
-	virtual void solve() {
-		solve(false);
+	std::ofstream proofFile;
+	std::unique_ptr<DratWriter> proof;
+	if (!erProof.getValue().empty()) {
+		proofFile.open(erProof.getValue(), std::ios::binary);
+		proof = std::make_unique<DratWriter>(proofFile);
+		sinks.push_back(proof.get());
 	}
 
-	virtual void solveIncremental() {
-		solve(true);
+	std::unique_ptr<RupChecker> checker;
+	if (checkProof.getValue()) {
+		checker = std::make_unique<RupChecker>();
+		sinks.push_back(checker.get());
 	}
 
-	virtual void solve(bool incremental){
-		// solver->set_learn(10000, [](int* learned) {
-		// 	for(;*learned != 0;learned++) {
-		// 		std::cout << *learned << " ";
-		// 	}
-		// 	std::cout << std::endl;
-		// });
-
-		bool solved;
-		addBorders(true);
-		for (unsigned numHoles = 1; numHoles < numPigeons; numHoles++) {
-			addHole(numHoles - 1);
-		}
-		addExtendedResolutionClauses();
-
-		if (incremental) {
-			for (unsigned step = 1; step < numPigeons; step++) {
-				CollectData::MakespanAndTime m(step);
-				learnClauses(step);
+	auto& result = SolveMetrics::current().result("erProof");
+	{
+		carj::ScopedTimer timer(result["time"]);
+		ERProofEmitter emitter(numberOfPigeons.getValue());
+		emitter.emit(sinks);
+	}
+
+	if (proof) {
+		result["numLemmas"] = proof->getNumLemmas();
+		result["numDeletions"] = proof->getNumDeletions();
+		result["numBytes"] = proof->getNumBytes();
+		LOG(INFO) << "lemmas: " << proof->getNumLemmas()
+			<< " deletions: " << proof->getNumDeletions()
+			<< " bytes: " << proof->getNumBytes();
+	}
+	if (checker) {
+		result["numChecked"] = checker->getNumChecked();
+		result["verified"] = checker->refuted();
+		if (checker->refuted()) {
+			LOG(INFO) << "Proof verified, " << checker->getNumChecked()
+				<< " lemmas checked.";
+		} else {
+			std::stringstream lemma;
+			for (int lit: checker->getFailedLemma()) {
+				lemma << lit << " ";
 			}
+			LOG(ERROR) << "Proof check failed at lemma: " << lemma.str() << "0";
 		}
-
-		solved = (solver->solve() == ipasir::SolveResult::SAT);
-		assert(!solved);
 	}
-
-	virtual ~ExtendedPHPEncoder3SAT(){
-
-	}
-};
-
-
-carj::TCarjArg<TCLAP::ValueArg, unsigned> numberOfPigeons("n", "numPigeons",
-	"Number of pigeons", !neccessaryArgument, 1, "natural number", cmd);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> dimspec("d", "dimspec", "Output dimspec.",
-	cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> print("p", "print", "Output as cnf.",
-	cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> extendedResolution("e", "extendedResolution",
-	"Add extended resolution formulas.", cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> incremental("i", "incremental",
-	"Solve formual incrementally.", cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> alternate("a", "alternate",
-	"alternate mode", cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> encoding3SAT("3", "3sat",
-	"Encode PHP in 3 SAT CNF.", cmd, defaultIsFalse);
-
-carj::CarjArg<TCLAP::SwitchArg, bool> record("r", "record",
-	"Record clause learning data.", cmd, defaultIsFalse);
+}
 
 int incphp_main(int argc, const char **argv) {
 	carj::init(argc, argv, cmd, "/incphp/parameters");
 
-	if (dimspec.getValue()) {
-		DimSpecFixedPigeons dsfp(numberOfPigeons.getValue());
-		dsfp.print();
-	} else {
-		std::unique_ptr<ipasir::Ipasir> solver;
-		if (print.getValue()) {
-			solver = std::make_unique<ipasir::Printer>();
+	// the workers of --learnWorkers are forked while solving, a lock held by
+	// one of these threads at that time would never be released in them
+	if (learnWorkers.getValue() != 1 && (learnThread.getValue()
+			|| asyncLog.getValue() || !progress.getValue().empty())) {
+		LOG(FATAL) << "--learnWorkers forks the solver, it can not be combined "
+			"with --learnThread, --asyncLog or --progress, which start threads.";
+	}
+	if (workers.getValue() > 0 && !progress.getValue().empty()) {
+		LOG(FATAL) << "--workers forks the worker processes, it can not be "
+			"combined with --progress, which starts a thread.";
+	}
+
+	if (asyncLog.getValue()) {
+		if (workers.getValue() > 0) {
+			LOG(WARNING) << "The worker processes are forked, using "
+				"synchronous logging.";
+		} else if (print.getValue() || dimspec.getValue()) {
+			LOG(WARNING) << "Asynchronous logging would interleave with the "
+				"formula output, using synchronous logging.";
 		} else {
-			solver = std::make_unique<ipasir::Solver>();
+			carj::startAsyncLogging();
 		}
-		solver = std::make_unique<ipasir::RandomizedSolver>(std::move(solver));
-		if (record.getValue()) {
-			solver = std::make_unique<LearnedClauseEvaluationDecorator>(std::move(solver));
+	}
+
+	if (!progress.getValue().empty()) {
+		ProgressExporter::Format format;
+		if (!ProgressExporter::formatFromName(progressFormat.getValue(), format)) {
+			LOG(FATAL) << "Unknown progress format '"
+				<< progressFormat.getValue() << "'.";
 		}
-		LOG(INFO) << "Using solver: " << solver->signature();
-
-		if (encoding3SAT.getValue()) {
-			if (extendedResolution.getValue()) {
-				std::unique_ptr<ExtendedPHPEncoder3SAT> encoder =
-					std::make_unique<ExtendedPHPEncoder3SAT>(
-							std::move(solver),
-							numberOfPigeons.getValue());
-				if (incremental.getValue()) {
-					encoder->solveIncremental();
-				} else {
-					encoder->solve();
-				}
-			} else {
-				std::unique_ptr<PHPEncoder3SAT> encoder;
-				if (alternate.getValue()) {
-					encoder = std::make_unique<AlternatePHPEncoder3SAT>(
-						std::move(solver),
-						numberOfPigeons.getValue());
-				} else {
-					encoder = std::make_unique<PHPEncoder3SAT>(
-							std::move(solver),
-							numberOfPigeons.getValue());
-				}
-
-				if (incremental.getValue()) {
-					encoder->solveIncremental();
-				} else {
-					encoder->solve();
-				}
-			}
-		} else {
-			if (extendedResolution.getValue()) {
-				LOG(FATAL) << "Unsupported Option";
-			}
+		if (cubeAndConquer.getValue()) {
+			LOG(WARNING) << "--progress only counts the solves of this "
+				"process, the workers are not included.";
+		}
+		progressExporter = std::make_unique<ProgressExporter>(
+			progress.getValue(), progressInterval.getValue(), format);
+	}
 
-			if (incremental.getValue()) {
-				SimpleIncrementalPHPEncoder encoder(
-					std::move(solver),
-					numberOfPigeons.getValue());
-				encoder.solve();
-			} else {
-				UniversalPHPEncoder encoder(
-					std::move(solver),
-					numberOfPigeons.getValue());
-				encoder.solve();
-			}
+	// results of the modes which do not go through solvePHP
+	SolveMetrics metrics;
+	{
+		SolveMetrics::Scope scope(metrics);
+		if (dimspec.getValue()) {
+			DimSpecFixedPigeons dsfp(numberOfPigeons.getValue());
+			dsfp.print();
+		} else if (!erProof.getValue().empty() || !erCnf.getValue().empty()
+				|| checkProof.getValue()) {
+			emitERProof();
+		} else if (workers.getValue() > 0) {
+			runWorkerPool();
+		} else if (cubeAndConquer.getValue()) {
+			solvePHPCubeAndConquer();
+		} else {
+			solvePHP(createSolver());
 		}
 	}
+	metrics.mergeInto(carj::getCarj().data["/incphp/result"_json_pointer]);
 
+	progressExporter.reset();
+	carj::stopAsyncLogging();
 	return 0;
 }
@@ -3,5 +3,18 @@
 #include "ipasir/ipasir_cpp.h"
 #include "tclap/CmdLine.h"
 
+#include <memory>
+
 extern TCLAP::CmdLine cmd;
-int incphp_main(int argc, const char **argv);
\ No newline at end of file
+int incphp_main(int argc, const char **argv);
+
+/**
+ * Create the solver stack selected by the parameters.
+ */
+std::unique_ptr<ipasir::Ipasir> createSolver();
+
+/**
+ * Encode and solve the pigeon hole principle or the instance family as
+ * selected by the parameters.
+ */
+void solvePHP(std::unique_ptr<ipasir::Ipasir> solver);
@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "carj/AsyncLog.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST( LogRingBuffer, fifo) {
+	carj::LogRingBuffer buffer(4);
+	carj::LogRingBuffer::Entry entry;
+
+	ASSERT_FALSE(buffer.tryPop(entry));
+	for (unsigned i = 0; i < buffer.capacity(); i++) {
+		ASSERT_TRUE(buffer.tryPush(el::Level::Info, "src/a.cpp", i,
+			std::to_string(i)));
+	}
+	ASSERT_FALSE(buffer.tryPush(el::Level::Info, "src/a.cpp", 0, "full"));
+	ASSERT_EQ(buffer.numPushed(), buffer.capacity());
+
+	for (unsigned i = 0; i < buffer.capacity(); i++) {
+		ASSERT_TRUE(buffer.tryPop(entry));
+		ASSERT_EQ(entry.line, i);
+		ASSERT_EQ(std::string(entry.message, entry.messageLength),
+			std::to_string(i));
+		ASSERT_EQ(std::string(entry.file, entry.fileLength), "a.cpp");
+	}
+	ASSERT_TRUE(buffer.empty());
+}
+
+TEST( LogRingBuffer, truncate) {
+	carj::LogRingBuffer buffer(2);
+	carj::LogRingBuffer::Entry entry;
+	std::string message(carj::LogRingBuffer::messageSize + 10, 'x');
+
+	ASSERT_TRUE(buffer.tryPush(el::Level::Warning, "b.cpp", 1, message));
+	ASSERT_TRUE(buffer.tryPop(entry));
+	ASSERT_EQ(entry.messageLength, carj::LogRingBuffer::messageSize);
+	ASSERT_EQ(entry.level, el::Level::Warning);
+}
+
+TEST( LogRingBuffer, multipleProducers) {
+	const unsigned numThreads = 4;
+	const unsigned numMessages = 2000;
+	carj::LogRingBuffer buffer(64);
+
+	std::vector<std::thread> producers;
+	for (unsigned t = 0; t < numThreads; t++) {
+		producers.emplace_back([&buffer, t]{
+			for (unsigned i = 0; i < numMessages; i++) {
+				while (!buffer.tryPush(el::Level::Info, "c.cpp", t, "m")) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<unsigned> received(numThreads, 0);
+	carj::LogRingBuffer::Entry entry;
+	for (unsigned i = 0; i < numThreads * numMessages;) {
+		if (buffer.tryPop(entry)) {
+			received[entry.line] += 1;
+			i++;
+		}
+	}
+
+	for (std::thread& producer: producers) {
+		producer.join();
+	}
+
+	for (unsigned count: received) {
+		ASSERT_EQ(count, numMessages);
+	}
+}
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+#include "ClauseFingerprint.h"
+#include "CountingSolver.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	void addClauses(ClauseFingerprint& fingerprint,
+			std::vector<std::vector<int>> clauses) {
+		for (std::vector<int>& clause: clauses) {
+			for (int lit: clause) {
+				fingerprint.add(lit);
+			}
+			fingerprint.add(0);
+		}
+	}
+
+	typedef std::function<void(std::unique_ptr<ipasir::Ipasir>, unsigned)>
+		Encoding;
+
+	std::string fingerprintOf(Encoding encoding, unsigned numPigeons) {
+		initTestCarj();
+		SolveMetrics metrics;
+		SolveMetrics::Scope scope(metrics);
+		encoding(
+			std::make_unique<FingerprintDecorator>(
+				std::make_unique<CountingSolver>()),
+			numPigeons);
+		return metrics.result("fingerprint");
+	}
+}
+
+TEST( ClauseFingerprint, clauseOrder) {
+	ClauseFingerprint a;
+	addClauses(a, {{1, -2}, {2, 3, 4}, {-1}});
+
+	ClauseFingerprint b;
+	addClauses(b, {{-1}, {4, 2, 3}, {-2, 1}});
+
+	ASSERT_EQ(a.value(), b.value());
+
+	ClauseFingerprint c;
+	addClauses(c, {{-1}, {4, 2, 3}, {-2, 1}, {-1}});
+	ASSERT_NE(a.value(), c.value());
+
+	ClauseFingerprint d;
+	addClauses(d, {{-1}, {4, 2}, {3, -2, 1}});
+	ASSERT_NE(a.value(), d.value());
+}
+
+TEST( ClauseFingerprint, sequence) {
+	ClauseFingerprint a;
+	addClauses(a, {{1, 2}});
+	a.assume(1);
+	a.assume(2);
+	a.solve();
+	addClauses(a, {{3}});
+
+	ClauseFingerprint b;
+	addClauses(b, {{1, 2}});
+	b.assume(2);
+	b.assume(1);
+	b.solve();
+	addClauses(b, {{3}});
+	ASSERT_NE(a.value(), b.value());
+
+	ClauseFingerprint c;
+	addClauses(c, {{1, 2}, {3}});
+	c.assume(1);
+	c.assume(2);
+	c.solve();
+	ASSERT_NE(a.value(), c.value());
+
+	ClauseFingerprint d;
+	addClauses(d, {{1, 2}});
+	d.assume(1);
+	d.assume(2);
+	d.solve();
+	addClauses(d, {{3}});
+	ASSERT_EQ(a.value(), d.value());
+}
+
+/**
+ * The golden values were recorded with the encoders as of introducing the
+ * fingerprint. Changes to the encoders which are meant to be pure
+ * optimizations must not change them.
+ */
+TEST( ClauseFingerprint, encoderGoldenValues) {
+	std::map<std::string, Encoding> encodings = {
+		{"direct", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			UniversalPHPEncoder(std::move(s), n).solve();
+		}},
+		{"directIncremental", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			SimpleIncrementalPHPEncoder(std::move(s), n).solve();
+		}},
+		{"3sat", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			PHPEncoder3SAT(std::move(s), n).solve();
+		}},
+		{"3satIncremental", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			PHPEncoder3SAT(std::move(s), n).solveIncremental();
+		}},
+		{"alternate", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			AlternatePHPEncoder3SAT(std::move(s), n).solve();
+		}},
+		{"alternateIncremental", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			AlternatePHPEncoder3SAT(std::move(s), n).solveIncremental();
+		}},
+		{"extended", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			ExtendedPHPEncoder3SAT(std::move(s), n).solve();
+		}},
+		{"extendedIncremental", [](std::unique_ptr<ipasir::Ipasir> s, unsigned n){
+			ExtendedPHPEncoder3SAT(std::move(s), n).solveIncremental();
+		}}
+	};
+
+	// values for 3, 4 and 5 pigeons, changing one also bumps encoderVersion
+	std::map<std::string, std::vector<std::string>> golden = {
+		{"direct", {
+			"a49b7845de300b5c", "5ca80a6ea7e105cc", "2d2147dd2e7aa432"}},
+		{"directIncremental", {
+			"95bf44d306702ed3", "926e4660820b3f8a", "c76cb38b7debdf53"}},
+		{"3sat", {
+			"ff65b6b73c87290e", "90afb2fb4df36a38", "41990f00df990bfa"}},
+		{"3satIncremental", {
+			"03749b0d1a4479bf", "2818801d958e0709", "5f3d3dfa339d514d"}},
+		{"alternate", {
+			"ff65b6b73c87290e", "90afb2fb4df36a38", "41990f00df990bfa"}},
+		{"alternateIncremental", {
+			"47138409c5aff3b5", "fa3e7409fef87c0a", "4d1969bd1a23ec46"}},
+		{"extended", {
+			"102ab762d932f9ba", "29fc17d51add6d9b", "c04e1773c09e8f4a"}},
+		{"extendedIncremental", {
+			"6f0ae6ddf78bcb7a", "b0101b7968bf9d5d", "e564f8ebd136bd3d"}}
+	};
+
+	for (auto& encoding: encodings) {
+		for (unsigned n = 3; n <= 5; n++) {
+			EXPECT_EQ(fingerprintOf(encoding.second, n),
+				golden[encoding.first][n - 3])
+				<< encoding.first << " n = " << n;
+		}
+	}
+}
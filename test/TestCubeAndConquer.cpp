@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "CubeAndConquer.h"
+#include "SolveMetrics.h"
+#include "TestHelpers.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace {
+	const unsigned n = 4;
+	// cubes which fix fewer pigeons time out
+	const unsigned solvedDepth = 3;
+
+	bool isPrefix(const std::vector<unsigned>& prefix,
+			const std::vector<unsigned>& cube) {
+		return prefix.size() <= cube.size()
+			&& std::equal(prefix.begin(), prefix.end(), cube.begin());
+	}
+}
+
+TEST(CubeAndConquer, timedOutCubesAreCoveredBySplits) {
+	initTestCarj();
+	SolveMetrics metrics;
+	SolveMetrics::Scope scope(metrics);
+
+	// the pigeon of each literal, the containers of the workers number the
+	// variables the same way
+	std::map<int, unsigned> pigeonOf;
+	BasicVariableContainer reference(n);
+	for (unsigned p = 0; p < n; p++) {
+		for (unsigned h = 0; h < n - 1; h++) {
+			pigeonOf[reference.pigeonInHole(p, h)] = p;
+		}
+	}
+
+	CubeAndConquer solver(n, 2, 10, 1, [&pigeonOf](unsigned) {
+		auto fake = std::make_unique<FakeSolver>();
+		FakeSolver* raw = fake.get();
+		raw->onSolve = [raw, &pigeonOf]() {
+			std::set<unsigned> fixed;
+			for (int lit: raw->assumed) {
+				fixed.insert(pigeonOf.at(std::abs(lit)));
+			}
+			raw->assumed.clear();
+			return (fixed.size() < solvedDepth) ?
+				ipasir::SolveResult::TIMEOUT : ipasir::SolveResult::UNSAT;
+		};
+		return std::make_unique<UniversalPHPEncoder>(std::move(fake),
+			std::make_unique<BasicVariableContainer>(n), n);
+	});
+
+	ASSERT_FALSE(solver.solve());
+
+	std::vector<std::vector<unsigned>> solved;
+	for (auto& entry: metrics.result("cubes")) {
+		if (entry["result"] != static_cast<int>(ipasir::SolveResult::TIMEOUT)) {
+			solved.push_back(entry["cube"].get<std::vector<unsigned>>());
+		}
+	}
+
+	// every assignment of the first pigeons, n - 1 stands for no hole
+	std::vector<unsigned> cube(solvedDepth, 0);
+	unsigned numCubes = 0;
+	while (true) {
+		unsigned numCovering = 0;
+		for (auto& prefix: solved) {
+			numCovering += isPrefix(prefix, cube);
+		}
+		EXPECT_EQ(numCovering, 1u);
+		numCubes += 1;
+
+		unsigned i = 0;
+		while (i < solvedDepth && ++cube[i] == n) {
+			cube[i] = 0;
+			i++;
+		}
+		if (i == solvedDepth) {
+			break;
+		}
+	}
+	EXPECT_EQ(numCubes, n * n * n);
+	EXPECT_EQ(metrics.result("cubeAndConquer")["numSplits"], n + n * n);
+}
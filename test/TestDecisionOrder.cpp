@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include "DecisionOrder.h"
+#include "CountingSolver.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include "ipasir/randomized_ipasir.h"
+
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <vector>
+
+TEST( DecisionOrder, mappedByRandomizedSolver) {
+	std::vector<int> received;
+	std::unique_ptr<FakeSolver> backend =
+		std::make_unique<FakeSolver>(received);
+	FakeSolver* selecting = backend.get();
+	ipasir::RandomizedSolver solver(1, std::move(backend));
+
+	solver.addClause({5});
+	solver.solve();
+	ASSERT_EQ(received.size(), 2u);
+
+	// 7 was never passed to the solver and is skipped
+	DecisionOrder decisions({7, 5, -5});
+	solver.set_select_literal([&decisions]() {
+		return decisions.select();
+	});
+
+	ASSERT_EQ(selecting->select(), received[0]);
+	ASSERT_EQ(selecting->select(), -received[0]);
+	ASSERT_EQ(selecting->select(), 0);
+	ASSERT_EQ(decisions.getNumRounds(), 1u);
+	for (unsigned i = 0; i < decisions.size(); i++) {
+		ASSERT_EQ(selecting->select(), 0);
+	}
+	ASSERT_EQ(selecting->select(), received[0]);
+}
+
+TEST( DecisionOrder, keptNumberingOfRandomizedSolver) {
+	std::vector<int> received;
+	std::unique_ptr<FakeSolver> backend =
+		std::make_unique<FakeSolver>(received);
+	FakeSolver* selecting = backend.get();
+	ipasir::RandomizedSolver solver(1, std::move(backend),
+		ipasir::VariableNumbering::Kept);
+
+	solver.addClause({9, -4});
+	solver.addClause({2});
+	solver.solve();
+	solver.addClause({-9, 7});
+	solver.solve();
+
+	// only the order of the clauses and literals may change
+	std::multiset<std::set<int>> clauses;
+	std::set<int> clause;
+	for (int lit: received) {
+		if (lit == 0) {
+			clauses.insert(clause);
+			clause.clear();
+		} else {
+			clause.insert(lit);
+		}
+	}
+	ASSERT_EQ(clauses, (std::multiset<std::set<int>>{
+		{9, -4}, {2}, {-9, 7}}));
+
+	DecisionOrder decisions({-4, 7});
+	solver.set_select_literal([&decisions]() {
+		return decisions.select();
+	});
+	ASSERT_EQ(selecting->select(), -4);
+	ASSERT_EQ(selecting->select(), 7);
+}
+
+TEST( DecisionOrder, idlesOnceExhausted) {
+	DecisionOrder decisions({1, 2, 3});
+	ASSERT_EQ(decisions.select(), 1);
+	ASSERT_EQ(decisions.select(), 2);
+	decisions.rewind();
+	ASSERT_EQ(decisions.select(), 1);
+	ASSERT_EQ(decisions.select(), 2);
+	ASSERT_EQ(decisions.select(), 3);
+
+	// everything is assigned, the solver decides on its own
+	for (unsigned i = 0; i <= decisions.size(); i++) {
+		ASSERT_EQ(decisions.select(), 0);
+	}
+	ASSERT_EQ(decisions.getNumRounds(), 1u);
+	ASSERT_EQ(decisions.select(), 1);
+
+	decisions.select();
+	decisions.select();
+	decisions.select();
+	decisions.rewind();
+	ASSERT_EQ(decisions.select(), 1);
+}
+
+TEST( DecisionOrder, encoderHeuristics) {
+	initTestCarj();
+
+	PHPEncoder3SAT encoder(std::make_unique<CountingSolver>(), 4);
+	std::vector<int> holeMajor = encoder.decisionOrder("holeMajor");
+	std::vector<int> pigeonMajor = encoder.decisionOrder("pigeonMajor");
+	ASSERT_EQ(holeMajor.size(), 12u);
+	ASSERT_EQ(std::set<int>(holeMajor.begin(), holeMajor.end()),
+		std::set<int>(pigeonMajor.begin(), pigeonMajor.end()));
+
+	std::vector<int> connectorFirst = encoder.decisionOrder("connectorFirst");
+	ASSERT_EQ(connectorFirst.size(), 4u * 2u + 12u);
+	ASSERT_LT(connectorFirst[0], 0);
+
+	ASSERT_TRUE(encoder.decisionOrder("unknown").empty());
+	ASSERT_FALSE(encoder.useDecisionOrder("unknown"));
+	ASSERT_TRUE(encoder.useDecisionOrder("connectorFirst"));
+}
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "ERProof.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST( ERProof, checkerAcceptsRefutation) {
+	for (unsigned n = 2; n <= 9; n++) {
+		RupChecker checker;
+		ERProofEmitter emitter(n);
+		emitter.emit({&checker});
+		ASSERT_TRUE(checker.refuted()) << "n = " << n;
+	}
+}
+
+TEST( ERProof, checkerRejectsLemma) {
+	RupChecker checker;
+	checker.original({1, 2});
+	checker.original({-1, 2});
+	checker.lemma({2});
+	ASSERT_FALSE(checker.hasFailed());
+
+	checker.lemma({-2});
+	ASSERT_TRUE(checker.hasFailed());
+	ASSERT_FALSE(checker.refuted());
+}
+
+TEST( ERProof, checkerAcceptsRat) {
+	RupChecker checker;
+	checker.original({1, 2});
+	// definition of 3 <-> 1 ^ 2
+	checker.lemma({-3, 1});
+	checker.lemma({-3, 2});
+	checker.lemma({3, -1, -2});
+	ASSERT_FALSE(checker.hasFailed());
+
+	// 4 does not occur negated
+	checker.lemma({4, -1});
+	ASSERT_FALSE(checker.hasFailed());
+	checker.lemma({-2, 3});
+	ASSERT_TRUE(checker.hasFailed());
+}
+
+TEST( ERProof, binaryDrat) {
+	std::stringstream out;
+	DratWriter writer(out);
+	writer.lemma({-63, 64});
+	writer.remove({1});
+
+	std::string expected = {'a', '\x7f', '\x80', '\x01', '\0', 'd', '\x02', '\0'};
+	ASSERT_EQ(out.str(), expected);
+	ASSERT_EQ(writer.getNumBytes(), expected.size());
+}
+
+TEST( ERProof, dimacs) {
+	std::stringstream out;
+	DimacsWriter writer(out);
+	ERProofEmitter emitter(3);
+	emitter.emit({&writer});
+
+	std::string header;
+	std::getline(out, header);
+	ASSERT_EQ(header, "p cnf 6 9");
+}
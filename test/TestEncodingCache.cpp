@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "EncodingCache.h"
+#include "ClauseFingerprint.h"
+#include "CountingSolver.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+	std::string tmpDirectory() {
+		char name[] = "/tmp/incphpCacheXXXXXX";
+		return mkdtemp(name);
+	}
+}
+
+TEST( EncodingCache, replayEqualsEncoder) {
+	initTestCarj();
+
+	std::string directory = tmpDirectory();
+	EncodingCache cache(directory, "3sat incremental 6");
+	ASSERT_FALSE(cache.replay(*std::make_unique<CountingSolver>()));
+
+	std::string encoded;
+	{
+		auto fingerprint = std::make_unique<FingerprintDecorator>(
+			std::make_unique<CountingSolver>());
+		FingerprintDecorator* recorded = fingerprint.get();
+		PHPEncoder3SAT encoder(cache.record(std::move(fingerprint)), 6);
+		encoder.solveIncremental();
+		cache.commit();
+		encoded = recorded->getFingerprint().toString();
+	}
+
+	FingerprintDecorator replayed(std::make_unique<CountingSolver>());
+	ASSERT_TRUE(cache.replay(replayed));
+	ASSERT_EQ(replayed.getFingerprint().toString(), encoded);
+
+	EncodingCache other(directory, "3sat incremental 7");
+	ASSERT_FALSE(other.replay(replayed));
+
+	std::remove(cache.getPath().c_str());
+	std::remove(directory.c_str());
+}
+
+TEST( EncodingCache, rejectsOtherKeysAndBrokenStreams) {
+	std::string directory = tmpDirectory();
+	EncodingCache cache(directory, "direct 4");
+	{
+		auto recorder = cache.record(std::make_unique<CountingSolver>());
+		recorder->add(1);
+		recorder->add(0);
+		recorder->assume(-1);
+		recorder->solve();
+		cache.commit();
+	}
+	CountingSolver counted;
+	ASSERT_TRUE(cache.replay(counted));
+
+	// a file of another key under the same name, as after a hash collision
+	EncodingCache other(directory, "direct 5");
+	ASSERT_EQ(std::rename(cache.getPath().c_str(), other.getPath().c_str()), 0);
+	ASSERT_FALSE(other.replay(counted));
+	ASSERT_EQ(std::rename(other.getPath().c_str(), cache.getPath().c_str()), 0);
+
+	// cut within the assumption and the solve mark
+	std::FILE* file = std::fopen(cache.getPath().c_str(), "rb");
+	std::string content;
+	for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) {
+		content.push_back(c);
+	}
+	std::fclose(file);
+	auto overwrite = [&](const std::string& bytes) {
+		std::FILE* out = std::fopen(cache.getPath().c_str(), "wb");
+		std::fwrite(bytes.data(), 1, bytes.size(), out);
+		std::fclose(out);
+	};
+
+	for (std::size_t cut: {1, 3, 4}) {
+		overwrite(content.substr(0, content.size() - 4 * cut));
+		CountingSolver truncated;
+		EXPECT_FALSE(cache.replay(truncated)) << cut;
+	}
+
+	std::string unknownKind = content;
+	std::int32_t kind = 7;
+	std::memcpy(&unknownKind[unknownKind.size() - 4], &kind, sizeof(kind));
+	overwrite(unknownKind);
+	CountingSolver unknown;
+	EXPECT_FALSE(cache.replay(unknown));
+
+	std::remove(cache.getPath().c_str());
+	std::remove(directory.c_str());
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "ForkedQueries.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+	std::vector<int> learnIncremental(unsigned numPigeons,
+			unsigned numWorkers) {
+		std::vector<int> received;
+		ExtendedPHPEncoder3SAT encoder(
+			std::make_unique<FakeSolver>(received), numPigeons);
+		encoder.setLearnWorkers(numWorkers);
+		encoder.solveIncremental();
+		return received;
+	}
+}
+
+TEST(ForkedQueries, resultsInQueryOrder) {
+	std::vector<ForkedQuery> results = solveForked(10, 3, [](unsigned query) {
+		return (query % 2 == 0) ?
+			ipasir::SolveResult::SAT : ipasir::SolveResult::UNSAT;
+	});
+
+	ASSERT_EQ(results.size(), 10u);
+	for (unsigned query = 0; query < 10; query++) {
+		EXPECT_EQ(results[query].result, (query % 2 == 0) ?
+			ipasir::SolveResult::SAT : ipasir::SolveResult::UNSAT);
+		EXPECT_EQ(results[query].worker, static_cast<int>(query % 3));
+		EXPECT_GE(results[query].time, 0);
+	}
+}
+
+TEST(ForkedQueries, workersDoNotChangeCaller) {
+	unsigned numCalls = 0;
+	solveForked(6, 2, [&numCalls](unsigned) {
+		numCalls += 1;
+		return ipasir::SolveResult::UNSAT;
+	});
+	EXPECT_EQ(numCalls, 0u);
+}
+
+TEST(ForkedQueries, singleWorkerRunsInProcess) {
+	unsigned numCalls = 0;
+	std::vector<ForkedQuery> results = solveForked(4, 1, [&numCalls](unsigned) {
+		numCalls += 1;
+		return ipasir::SolveResult::UNSAT;
+	});
+	EXPECT_EQ(numCalls, 4u);
+	for (const ForkedQuery& result: results) {
+		EXPECT_EQ(result.worker, -1);
+	}
+}
+
+TEST(ForkedQueries, crashedWorkerIsReplacedByCaller) {
+	pid_t caller = getpid();
+	std::vector<ForkedQuery> results = solveForked(6, 2, [caller](unsigned query) {
+		if (query == 3 && getpid() != caller) {
+			_exit(1);
+		}
+		return ipasir::SolveResult::UNSAT;
+	});
+
+	ASSERT_EQ(results.size(), 6u);
+	for (const ForkedQuery& result: results) {
+		EXPECT_EQ(result.result, ipasir::SolveResult::UNSAT);
+	}
+	EXPECT_EQ(results[1].worker, 1);
+	EXPECT_EQ(results[3].worker, -1);
+	EXPECT_EQ(results[5].worker, -1);
+	EXPECT_EQ(results[4].worker, 0);
+}
+
+TEST(ForkedQueries, learnClausesAddsProvenClauses) {
+	initTestCarj();
+
+	unsigned numPigeons = 6;
+	std::vector<int> sequential = learnIncremental(numPigeons, 1);
+	std::vector<int> forked = learnIncremental(numPigeons, 3);
+
+	ASSERT_GT(forked.size(), sequential.size());
+	ASSERT_TRUE(std::equal(sequential.begin(), sequential.end(),
+		forked.begin()));
+
+	long numProven = 0;
+	for (unsigned step = 1; step < numPigeons; step++) {
+		unsigned numHoles = numPigeons - 1 - step;
+		unsigned n = numPigeons - step;
+		numProven += numHoles * n * (n - 1) / 2 + (n - 1);
+	}
+	EXPECT_EQ(std::count(forked.begin(), forked.end(), 0)
+		- std::count(sequential.begin(), sequential.end(), 0), numProven);
+}
+
+TEST(ForkedQueries, stuckWorkerIsKilled) {
+	pid_t caller = getpid();
+	std::vector<ForkedQuery> results = solveForked(4, 2, [caller](unsigned query) {
+		if (query == 1 && getpid() != caller) {
+			sleep(60);
+		}
+		return ipasir::SolveResult::UNSAT;
+	}, 0.2);
+
+	ASSERT_EQ(results.size(), 4u);
+	for (const ForkedQuery& result: results) {
+		EXPECT_EQ(result.result, ipasir::SolveResult::UNSAT);
+	}
+	EXPECT_EQ(results[0].worker, 0);
+	EXPECT_EQ(results[1].worker, -1);
+	EXPECT_EQ(results[3].worker, -1);
+}
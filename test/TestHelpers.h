@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ipasir/ipasir_cpp.h"
+#include "carj/carj.h"
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Initialize carj with empty parameters, the encoders read their options
+ * from it.
+ */
+inline void initTestCarj() {
+	carj::getCarj().init(carj::Carj::configPath, false,
+		"/incphp/parameters");
+	if (carj::getCarj().parameter->is_null()) {
+		*carj::getCarj().parameter = nlohmann::json::object();
+	}
+}
+
+/**
+ * Solver stub of the tests. It records the added literals and the
+ * assumptions, learns the clauses in learned which fit the length given to
+ * set_learn, answers with onSolve, UNSAT if it is not set, and val with
+ * model. The callbacks set from above are kept, so onSolve and the test
+ * can call them.
+ */
+class FakeSolver: public ipasir::Ipasir {
+public:
+	FakeSolver():
+		added(ownAdded)
+	{
+	}
+
+	/**
+	 * Record the added literals to a vector which outlives the solver, i.e.
+	 * when an encoder owns it.
+	 */
+	FakeSolver(std::vector<int>& _added):
+		added(_added)
+	{
+	}
+
+	virtual std::string signature() {
+		return "fake";
+	}
+
+	virtual void add(int lit_or_zero) {
+		added.push_back(lit_or_zero);
+	}
+
+	virtual void assume(int lit) {
+		assumed.push_back(lit);
+	}
+
+	virtual ipasir::SolveResult solve() {
+		for (std::vector<int> clause: learned) {
+			if (learn && clause.size() <= static_cast<unsigned>(maxLength)) {
+				clause.push_back(0);
+				learn(clause.data());
+			}
+		}
+		if (onSolve) {
+			return onSolve();
+		}
+		return ipasir::SolveResult::UNSAT;
+	}
+
+	virtual int val(int lit) {
+		unsigned variable = std::abs(lit);
+		if (variable >= model.size()) {
+			return 0;
+		}
+		return model[variable] ? lit : -lit;
+	}
+
+	virtual int failed(int) {
+		return 0;
+	}
+
+	virtual void set_terminate(std::function<int(void)> callback) {
+		terminate = callback;
+	}
+
+	virtual void set_learn(int max_length,
+			std::function<void(int*)> callback) {
+		maxLength = max_length;
+		learn = callback;
+	}
+
+	virtual void set_select_literal(std::function<int(void)> callback) {
+		select = callback;
+	}
+
+	/**
+	 * A reset solver has no clauses, so the recorded calls are cleared.
+	 */
+	virtual void reset() {
+		added.clear();
+		assumed.clear();
+	}
+
+	std::vector<int>& added;
+	std::vector<int> assumed;
+	std::vector<std::vector<int>> learned;
+	std::function<ipasir::SolveResult()> onSolve;
+	// assignment of each variable, answered by val
+	std::vector<bool> model;
+
+	std::function<int(void)> terminate;
+	std::function<int(void)> select;
+
+private:
+	std::vector<int> ownAdded;
+	int maxLength = 0;
+	std::function<void(int*)> learn;
+};
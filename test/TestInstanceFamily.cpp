@@ -0,0 +1,257 @@
+#include "gtest/gtest.h"
+#include "InstanceFamily.h"
+#include "TestHelpers.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	typedef std::vector<std::vector<int>> Formula;
+
+	/**
+	 * Plain DPLL with unit propagation, good enough for small instances.
+	 */
+	bool dpll(const Formula& formula, std::vector<int>& assignment) {
+		bool changed = true;
+		std::vector<int> trail;
+		auto value = [&assignment](int lit) {
+			int v = assignment[std::abs(lit)];
+			return (lit > 0) ? v : -v;
+		};
+
+		int branch = 0;
+		while (changed) {
+			changed = false;
+			branch = 0;
+			for (const std::vector<int>& clause: formula) {
+				int numOpen = 0;
+				int open = 0;
+				bool satisfied = false;
+				for (int lit: clause) {
+					if (value(lit) > 0) {
+						satisfied = true;
+						break;
+					} else if (value(lit) == 0) {
+						numOpen += 1;
+						open = lit;
+					}
+				}
+				if (satisfied) {
+					continue;
+				}
+				if (numOpen == 0) {
+					for (int lit: trail) {
+						assignment[std::abs(lit)] = 0;
+					}
+					return false;
+				}
+				if (numOpen == 1) {
+					assignment[std::abs(open)] = (open > 0) ? 1 : -1;
+					trail.push_back(open);
+					changed = true;
+				} else if (branch == 0) {
+					branch = open;
+				}
+			}
+		}
+
+		if (branch != 0) {
+			for (int lit: {branch, -branch}) {
+				assignment[std::abs(lit)] = (lit > 0) ? 1 : -1;
+				if (dpll(formula, assignment)) {
+					return true;
+				}
+				assignment[std::abs(lit)] = 0;
+			}
+			for (int lit: trail) {
+				assignment[std::abs(lit)] = 0;
+			}
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Removes clauses from the formula of a solve call, the assumptions are
+	 * the negated activation literals of the solved step.
+	 */
+	typedef std::function<void(Formula& formula,
+		const std::vector<int>& assumptions)> Relaxation;
+
+	/**
+	 * Checks each solve call with dpll and records the results. With a
+	 * relaxation the relaxed formula is checked, but UNSAT is returned, as
+	 * the families assert that every step is unsatisfiable.
+	 */
+	class DpllSolver: public ipasir::Ipasir {
+	public:
+		DpllSolver(std::vector<ipasir::SolveResult>& _results,
+				Relaxation _relax = nullptr):
+			results(_results),
+			relax(_relax) {
+		}
+
+		virtual std::string signature() {
+			return "test-dpll";
+		}
+
+		virtual void add(int lit_or_zero) {
+			if (lit_or_zero == 0) {
+				formula.push_back(clause);
+				clause.clear();
+			} else {
+				clause.push_back(lit_or_zero);
+				numVars = std::max(numVars, std::abs(lit_or_zero));
+			}
+		}
+
+		virtual void assume(int lit) {
+			assumptions.push_back(lit);
+		}
+
+		virtual ipasir::SolveResult solve() {
+			Formula assumed = formula;
+			if (relax) {
+				relax(assumed, assumptions);
+			}
+			for (int lit: assumptions) {
+				assumed.push_back({lit});
+				numVars = std::max(numVars, std::abs(lit));
+			}
+			assumptions.clear();
+
+			std::vector<int> assignment(numVars + 1, 0);
+			results.push_back(dpll(assumed, assignment) ?
+				ipasir::SolveResult::SAT : ipasir::SolveResult::UNSAT);
+			return relax ? ipasir::SolveResult::UNSAT : results.back();
+		}
+
+		virtual int val(int lit) {
+			return lit;
+		}
+
+		virtual int failed(int) {
+			return 1;
+		}
+
+		virtual void set_terminate(std::function<int(void)>) {
+		}
+
+		virtual void set_learn(int, std::function<void(int*)>) {
+		}
+
+		virtual void reset() {
+			formula.clear();
+		}
+
+	private:
+		std::vector<ipasir::SolveResult>& results;
+		Relaxation relax;
+		Formula formula;
+		std::vector<int> clause;
+		std::vector<int> assumptions;
+		int numVars = 0;
+	};
+}
+
+TEST( InstanceFamily, everyStepIsUnsat) {
+	initTestCarj();
+
+	for (auto& entry: instanceFamilies()) {
+		unsigned size = (entry.first == "mutilatedChessboard") ? 2 : 5;
+		std::vector<ipasir::SolveResult> results;
+		std::unique_ptr<InstanceFamily> instance = entry.second(
+			std::make_unique<DpllSolver>(results), size, 0);
+		instance->solve(true);
+
+		ASSERT_EQ(results.size(), instance->getNumSteps()) << entry.first;
+		for (ipasir::SolveResult result: results) {
+			ASSERT_EQ(result, ipasir::SolveResult::UNSAT) << entry.first;
+		}
+	}
+}
+
+namespace {
+	bool isActivated(const std::vector<int>& clause,
+			const std::vector<int>& assumptions) {
+		for (int lit: assumptions) {
+			if (std::find(clause.begin(), clause.end(), -lit) != clause.end()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Drop the first clause which only holds for the solved step.
+	 */
+	void dropFirstActivated(Formula& formula,
+			const std::vector<int>& assumptions) {
+		for (auto it = formula.begin(); it != formula.end(); ++it) {
+			if (isActivated(*it, assumptions)) {
+				formula.erase(it);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Drop all clauses which only hold for the solved step.
+	 */
+	void dropActivated(Formula& formula,
+			const std::vector<int>& assumptions) {
+		formula.erase(std::remove_if(formula.begin(), formula.end(),
+			[&assumptions](const std::vector<int>& clause) {
+				return isActivated(clause, assumptions);
+			}), formula.end());
+	}
+
+	/**
+	 * The first clause forbids one assignment with even parity around the
+	 * vertex with odd charge.
+	 */
+	void dropFirst(Formula& formula, const std::vector<int>&) {
+		formula.erase(formula.begin());
+	}
+}
+
+/**
+ * Without the constraint, which makes the family unsatisfiable, the last
+ * step is satisfiable. So the steps are not refuted by clauses which are
+ * contradictory on their own.
+ */
+TEST( InstanceFamily, relaxedLastStepIsSat) {
+	initTestCarj();
+
+	const std::map<std::string, Relaxation> relaxations = {
+		// one pigeon less than holes
+		{"php", dropFirstActivated},
+		{"sparsePHP", dropFirstActivated},
+		{"functionalPHP", dropFirstActivated},
+		{"ontoPHP", dropFirstActivated},
+		// the cells next to the removed corners may be covered by them
+		{"mutilatedChessboard", dropActivated},
+		// the charges sum up to even
+		{"tseitin", dropFirst},
+		// the clique is one vertex smaller than the number of colors
+		{"cliqueColoring", dropFirstActivated},
+	};
+
+	for (auto& entry: instanceFamilies()) {
+		ASSERT_EQ(relaxations.count(entry.first), 1u) << entry.first;
+		unsigned size = (entry.first == "mutilatedChessboard") ? 2 : 5;
+		std::vector<ipasir::SolveResult> results;
+		std::unique_ptr<InstanceFamily> instance = entry.second(
+			std::make_unique<DpllSolver>(results,
+				relaxations.at(entry.first)), size, 0);
+		instance->solve(false);
+
+		ASSERT_EQ(results.size(), 1u) << entry.first;
+		EXPECT_EQ(results.back(), ipasir::SolveResult::SAT) << entry.first;
+	}
+}
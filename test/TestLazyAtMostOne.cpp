@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+#include "PHPEncoder.h"
+#include "SolveMetrics.h"
+#include "TestHelpers.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+	/**
+	 * Backtracking search over the clauses added to a fake solver, which
+	 * is enough for the small instances of the tests.
+	 */
+	class BruteForce {
+	public:
+		BruteForce(FakeSolver& _solver):
+			solver(_solver)
+		{
+		}
+
+		ipasir::SolveResult operator()() {
+			// clauses by their largest variable, the assumptions are units
+			clauses.clear();
+			std::vector<int> clause;
+			auto addClause = [this](const std::vector<int>& clause) {
+				unsigned maxVariable = 0;
+				for (int lit: clause) {
+					maxVariable = std::max<unsigned>(maxVariable, std::abs(lit));
+				}
+				if (clauses.size() <= maxVariable) {
+					clauses.resize(maxVariable + 1);
+				}
+				clauses[maxVariable].push_back(clause);
+			};
+			for (int lit: solver.added) {
+				if (lit == 0) {
+					addClause(clause);
+					clause.clear();
+				} else {
+					clause.push_back(lit);
+				}
+			}
+			for (int lit: solver.assumed) {
+				addClause({lit});
+			}
+			solver.assumed.clear();
+
+			solver.model.assign(clauses.size(), false);
+			return search(1) ?
+				ipasir::SolveResult::SAT : ipasir::SolveResult::UNSAT;
+		}
+
+	private:
+		FakeSolver& solver;
+		std::vector<std::vector<std::vector<int>>> clauses;
+
+		bool search(unsigned variable) {
+			if (variable >= clauses.size()) {
+				return true;
+			}
+			for (bool value: {true, false}) {
+				solver.model[variable] = value;
+				if (isConsistent(variable) && search(variable + 1)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool isConsistent(unsigned variable) {
+			for (const std::vector<int>& clause: clauses[variable]) {
+				bool satisfied = false;
+				for (int lit: clause) {
+					satisfied |= (solver.val(lit) > 0);
+				}
+				if (!satisfied) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	const unsigned n = 5;
+	const unsigned numEager = n * (n - 1) / 2 * (n - 1);
+
+	FakeSolver* addBruteForce(std::unique_ptr<FakeSolver>& fake,
+			ipasir::SolveResult& last) {
+		fake->onSolve = [&last, search = BruteForce(*fake)]() mutable {
+			last = search();
+			return last;
+		};
+		return fake.get();
+	}
+
+	unsigned numClauses(const std::vector<int>& added) {
+		return std::count(added.begin(), added.end(), 0);
+	}
+
+	ipasir::SolveResult solveDirect() {
+		auto fake = std::make_unique<FakeSolver>();
+		ipasir::SolveResult last = ipasir::SolveResult::TIMEOUT;
+		addBruteForce(fake, last);
+
+		UniversalPHPEncoder encoder(std::move(fake), n);
+		encoder.solve();
+		return last;
+	}
+}
+
+TEST(LazyAtMostOne, sameResultAsEager) {
+	initTestCarj();
+
+	SolveMetrics eager;
+	{
+		SolveMetrics::Scope scope(eager);
+		ASSERT_EQ(solveDirect(), ipasir::SolveResult::UNSAT);
+	}
+
+	SolveMetrics lazy;
+	(*carj::getCarj().parameter)["lazyAtMostOne"] = true;
+	{
+		SolveMetrics::Scope scope(lazy);
+		EXPECT_EQ(solveDirect(), ipasir::SolveResult::UNSAT);
+	}
+	carj::getCarj().parameter->erase("lazyAtMostOne");
+
+	auto& result = lazy.result("lazyAtMostOne");
+	ASSERT_TRUE(result.is_object());
+	EXPECT_GT(result["numRefinements"], 0u);
+	EXPECT_EQ(result["numEager"], numEager);
+	// dropping any one at most one clause makes the formula satisfiable,
+	// so it is only refuted once all of them are added
+	EXPECT_EQ(result["numMaterialized"], numEager);
+}
+
+TEST(LazyAtMostOne, cubeNeedsFewerClauses) {
+	initTestCarj();
+	(*carj::getCarj().parameter)["lazyAtMostOne"] = true;
+
+	auto fake = std::make_unique<FakeSolver>();
+	ipasir::SolveResult last = ipasir::SolveResult::TIMEOUT;
+	FakeSolver* solver = addBruteForce(fake, last);
+
+	UniversalPHPEncoder encoder(std::move(fake), n);
+	encoder.encode();
+	unsigned numEncoded = numClauses(solver->added);
+	EXPECT_EQ(numEncoded, n);
+
+	// refuted by the clauses of the first pigeon in the first hole and of
+	// the other pigeons in the other holes
+	EXPECT_EQ(encoder.solveCube({encoder.getVar()->pigeonInHole(0, 0)}),
+		ipasir::SolveResult::UNSAT);
+	EXPECT_EQ(last, ipasir::SolveResult::UNSAT);
+	unsigned numMaterialized = numClauses(solver->added) - numEncoded;
+	EXPECT_GT(numMaterialized, 0u);
+	EXPECT_LT(numMaterialized, numEager);
+
+	carj::getCarj().parameter->erase("lazyAtMostOne");
+}
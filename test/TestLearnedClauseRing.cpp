@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "ipasir/learned_clause_ring.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+	std::vector<int> clause(unsigned i) {
+		std::vector<int> result;
+		for (unsigned j = 0; j <= i % 7; j++) {
+			result.push_back((j % 2 == 0)? i + j + 1 : -(i + j + 1));
+		}
+		return result;
+	}
+
+	void consume(std::vector<std::vector<int>>& consumed,
+			int* begin, int* end) {
+		ipasir::forEachClause(begin, end, [&consumed](int* learned) {
+			std::vector<int> literals;
+			for (; *learned != 0; learned++) {
+				literals.push_back(*learned);
+			}
+			consumed.push_back(literals);
+		});
+	}
+}
+
+TEST( LearnedClauseRing, wrapsAround) {
+	ipasir::LearnedClauseRing ring(32);
+	ASSERT_EQ(ring.maxLength(), 14u);
+
+	std::vector<std::vector<int>> consumed;
+	unsigned numPushed = 0;
+	for (unsigned round = 0; round < 20; round++) {
+		while (true) {
+			std::vector<int> next = clause(numPushed);
+			next.push_back(0);
+			if (!ring.push(next.data(), next.size() - 1)) {
+				break;
+			}
+			numPushed++;
+		}
+		ring.drain([&consumed](int* begin, int* end) {
+			consume(consumed, begin, end);
+		});
+		ASSERT_TRUE(ring.empty());
+	}
+
+	ASSERT_EQ(consumed.size(), numPushed);
+	for (unsigned i = 0; i < numPushed; i++) {
+		ASSERT_EQ(consumed[i], clause(i));
+	}
+
+	std::vector<int> tooLong(32, 1);
+	ASSERT_FALSE(ring.push(tooLong.data(), tooLong.size() - 1));
+}
+
+TEST( LearnedClauseRing, consumerThread) {
+	const unsigned numClauses = 100000;
+	ipasir::LearnedClauseRing ring(64);
+	std::vector<std::vector<int>> consumed;
+
+	std::thread producer([&ring, numClauses]() {
+		for (unsigned i = 0; i < numClauses; i++) {
+			std::vector<int> next = clause(i);
+			next.push_back(0);
+			while (!ring.push(next.data(), next.size() - 1)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	while (consumed.size() < numClauses) {
+		std::size_t released = ring.drain([&consumed](int* begin, int* end) {
+			consume(consumed, begin, end);
+		});
+		if (released == 0) {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	ASSERT_TRUE(ring.empty());
+	for (unsigned i = 0; i < numClauses; i++) {
+		ASSERT_EQ(consumed[i], clause(i));
+	}
+}
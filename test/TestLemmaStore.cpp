@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "LemmaStore.h"
+#include "TestHelpers.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	std::string tmpDirectory() {
+		char name[] = "/tmp/incphpLemmasXXXXXX";
+		return mkdtemp(name);
+	}
+
+}
+
+TEST( LemmaStore, saveAndLoad) {
+	initTestCarj();
+
+	std::string directory = tmpDirectory();
+	{
+		LemmaStore store(directory, "3sat 6", 3);
+		auto learning = std::make_unique<FakeSolver>();
+		learning->learned = {{2, -1}, {1, 2, 3, 4}, {-1, 9}};
+		auto solver = store.collect(std::move(learning));
+		ASSERT_EQ(store.load(*solver), 0u);
+
+		// the long clause and the unknown variable 9 are not stored
+		unsigned numForwarded = 0;
+		solver->set_learn(10, [&numForwarded](int*) {
+			numForwarded += 1;
+		});
+		solver->addClause({1, 2, 3, 4});
+		solver->solve();
+		ASSERT_EQ(numForwarded, 3u);
+		store.save();
+	}
+
+	LemmaStore store(directory, "3sat 6", 3);
+	FakeSolver loaded;
+	ASSERT_EQ(store.load(loaded), 1u);
+	ASSERT_EQ(loaded.added, std::vector<int>({-1, 2, 0}));
+
+	LemmaStore other(directory, "3sat 7", 3);
+	ASSERT_EQ(other.load(loaded), 0u);
+
+	std::remove(store.getPath().c_str());
+	std::remove(directory.c_str());
+}
@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include "MakespanSchedule.h"
+
+#include <vector>
+
+namespace {
+	/**
+	 * Makespans solved by the schedule if the first satisfiable makespan
+	 * is firstSat, 0 for none.
+	 */
+	std::vector<unsigned> run(MakespanSchedule schedule,
+			unsigned maxMakespan, unsigned firstSat = 0) {
+		std::vector<unsigned> solved;
+		schedule.start(maxMakespan);
+		for (unsigned makespan = schedule.next(); makespan != 0;
+				makespan = schedule.next()) {
+			solved.push_back(makespan);
+			schedule.report(firstSat != 0 && makespan >= firstSat);
+		}
+		return solved;
+	}
+}
+
+TEST( MakespanSchedule, linear) {
+	MakespanSchedule schedule(MakespanSchedule::Kind::LINEAR);
+	ASSERT_EQ(run(schedule, 4), std::vector<unsigned>({1, 2, 3, 4}));
+	ASSERT_EQ(run(schedule, 4, 2), std::vector<unsigned>({1, 2}));
+}
+
+TEST( MakespanSchedule, exponential) {
+	MakespanSchedule schedule(MakespanSchedule::Kind::EXPONENTIAL);
+	ASSERT_EQ(run(schedule, 10), std::vector<unsigned>({1, 2, 4, 8, 10}));
+	ASSERT_EQ(run(schedule, 8), std::vector<unsigned>({1, 2, 4, 8}));
+}
+
+TEST( MakespanSchedule, skip) {
+	MakespanSchedule schedule(MakespanSchedule::Kind::SKIP, 3);
+	ASSERT_EQ(run(schedule, 10), std::vector<unsigned>({3, 6, 9, 10}));
+	ASSERT_EQ(run(schedule, 10, 5), std::vector<unsigned>({3, 6}));
+}
+
+TEST( MakespanSchedule, binary) {
+	MakespanSchedule schedule(MakespanSchedule::Kind::BINARY);
+	ASSERT_EQ(run(schedule, 9), std::vector<unsigned>({5, 7, 8, 9}));
+	ASSERT_EQ(run(schedule, 9, 3), std::vector<unsigned>({5, 2, 3}));
+	ASSERT_EQ(run(schedule, 1), std::vector<unsigned>({1}));
+}
+
+TEST( MakespanSchedule, fromName) {
+	MakespanSchedule schedule;
+	ASSERT_TRUE(MakespanSchedule::fromName("skip", 2, schedule));
+	ASSERT_EQ(schedule.name(), "skip");
+	ASSERT_EQ(run(schedule, 5), std::vector<unsigned>({2, 4, 5}));
+	ASSERT_FALSE(MakespanSchedule::fromName("random", 2, schedule));
+}
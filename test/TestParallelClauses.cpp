@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+#include "ParallelClauses.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+	template<class Encoder>
+	std::vector<int> encode(unsigned numPigeons, unsigned numThreads) {
+		std::vector<int> received;
+		Encoder encoder(
+			std::make_unique<FakeSolver>(received), numPigeons);
+		encoder.setEncodeThreads(numThreads);
+		encoder.encode();
+		return received;
+	}
+}
+
+TEST( ParallelClauses, rangesInOrder) {
+	std::vector<int> received;
+	FakeSolver solver(received);
+	generateClauses(solver, 100, 4, [](unsigned range, auto& out) {
+		for (unsigned i = 0; i < range % 7; i++) {
+			out.add(range + 1);
+		}
+		out.add(0);
+	});
+
+	std::vector<int> expected;
+	for (unsigned range = 0; range < 100; range++) {
+		for (unsigned i = 0; i < range % 7; i++) {
+			expected.push_back(range + 1);
+		}
+		expected.push_back(0);
+	}
+	ASSERT_EQ(received, expected);
+}
+
+TEST( ParallelClauses, sameFormulaAsSequential) {
+	initTestCarj();
+
+	for (unsigned numThreads: {0u, 2u, 5u}) {
+		ASSERT_EQ(encode<UniversalPHPEncoder>(9, numThreads),
+			encode<UniversalPHPEncoder>(9, 1));
+		ASSERT_EQ(encode<PHPEncoder3SAT>(9, numThreads),
+			encode<PHPEncoder3SAT>(9, 1));
+		ASSERT_EQ(encode<ExtendedPHPEncoder3SAT>(9, numThreads),
+			encode<ExtendedPHPEncoder3SAT>(9, 1));
+	}
+}
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "ProgressExporter.h"
+#include "TestHelpers.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+	std::string tmpFile() {
+		char name[] = "/tmp/incphpProgressXXXXXX";
+		int fd = mkstemp(name);
+		close(fd);
+		return name;
+	}
+
+	std::string readFile(const std::string& path) {
+		std::ifstream in(path);
+		std::stringstream contents;
+		contents << in.rdbuf();
+		return contents.str();
+	}
+}
+
+TEST( ProgressExporter, json) {
+	std::string path = tmpFile();
+
+	ProgressCounters& counters = progressCounters();
+	std::uint64_t numSolves = counters.numSolves;
+	std::uint64_t numLearned = counters.numLearned;
+	{
+		ProgressExporter exporter(path, 3600,
+			ProgressExporter::Format::JSON);
+		auto learning = std::make_unique<FakeSolver>();
+		learning->learned = {{1, 2}, {1, 2, 3, 4}};
+		ProgressDecorator solver(std::move(learning), &exporter, 3);
+
+		unsigned numForwarded = 0;
+		solver.set_learn(10, [&numForwarded](int*) {
+			numForwarded += 1;
+		});
+		solver.solve();
+		solver.solve();
+		ASSERT_EQ(numForwarded, 4u);
+	}
+	ASSERT_EQ(counters.numSolves, numSolves + 2);
+	ASSERT_EQ(counters.numLearned, numLearned + 2);
+
+	nlohmann::json sample = nlohmann::json::parse(readFile(path));
+	ASSERT_EQ(sample["numSolves"].get<std::uint64_t>(), numSolves + 2);
+	ASSERT_FALSE(sample["solving"].get<bool>());
+	ASSERT_GT(sample["rss"].get<std::uint64_t>(), 0u);
+
+	std::remove(path.c_str());
+}
+
+TEST( ProgressExporter, prometheus) {
+	ProgressExporter::Format format;
+	ASSERT_TRUE(ProgressExporter::formatFromName("prometheus", format));
+	ASSERT_FALSE(ProgressExporter::formatFromName("xml", format));
+
+	std::string path = tmpFile();
+	{
+		ProgressExporter exporter(path, 3600, format);
+	}
+	std::string contents = readFile(path);
+	ASSERT_NE(contents.find("# TYPE incphp_solves_total counter\n"),
+		std::string::npos);
+	ASSERT_NE(contents.find("\nincphp_resident_bytes "), std::string::npos);
+
+	std::remove(path.c_str());
+}
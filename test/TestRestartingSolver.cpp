@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "RestartingSolver.h"
+#include "TestHelpers.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+	/**
+	 * Runs until it is terminated in the first numTimeouts solves.
+	 */
+	std::unique_ptr<FakeSolver> stallingSolver(unsigned numTimeouts,
+			FakeSolver*& stalling) {
+		auto solver = std::make_unique<FakeSolver>();
+		stalling = solver.get();
+		solver->onSolve = [stalling, numTimeouts]() mutable {
+			if (numTimeouts > 0) {
+				numTimeouts -= 1;
+				while (!stalling->terminate()) {
+				}
+				return ipasir::SolveResult::TIMEOUT;
+			}
+			return ipasir::SolveResult::UNSAT;
+		};
+		return solver;
+	}
+}
+
+TEST( RestartingSolver, luby) {
+	std::vector<unsigned> expected = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8};
+	for (unsigned i = 0; i < expected.size(); i++) {
+		ASSERT_EQ(RestartingSolver::luby(i + 1), expected[i]);
+	}
+}
+
+TEST( RestartingSolver, replaysAfterTimeout) {
+	FakeSolver* stalling;
+	RestartingSolver solver(stallingSolver(3, stalling), 0.001);
+
+	solver.addClause({1, 2});
+	solver.addClause({-1});
+	solver.assume(-2);
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::UNSAT);
+
+	ASSERT_EQ(stalling->added, std::vector<int>({1, 2, 0, -1, 0}));
+	ASSERT_EQ(stalling->assumed, std::vector<int>({-2}));
+}
+
+TEST( RestartingSolver, passesTerminationFromAbove) {
+	FakeSolver* stalling;
+	RestartingSolver solver(stallingSolver(1, stalling), 10);
+	solver.set_terminate([]() { return 1; });
+	solver.addClause({1});
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::TIMEOUT);
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::UNSAT);
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "ResultAggregator.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	nlohmann::json run(unsigned seed, bool incremental,
+			std::vector<double> times) {
+		nlohmann::json result;
+		result["incphp"]["parameters"] = {
+			{"seed", seed},
+			{"incremental", incremental},
+			{"numPigeons", 5}
+		};
+		auto& solves = result["incphp"]["result"]["solves"];
+		solves = nlohmann::json::array();
+		for (unsigned i = 0; i < times.size(); i++) {
+			solves.push_back({{"makespan", i + 1}, {"time", times[i]}});
+		}
+		result["incphp"]["result"]["learnedClauseEval"] = {
+			{"numLearnedClauses", 10 * seed}
+		};
+		return result;
+	}
+
+	std::vector<std::string> lines(const ResultAggregator& aggregator) {
+		std::stringstream csv;
+		aggregator.writeCsv(csv);
+		std::vector<std::string> result;
+		std::string line;
+		while (std::getline(csv, line)) {
+			result.push_back(line);
+		}
+		return result;
+	}
+}
+
+TEST(ResultAggregator, groupsBySeedlessParameters) {
+	ResultAggregator aggregator;
+	EXPECT_EQ(aggregator.addDocument(run(1, true, {1, 4})), 1u);
+	EXPECT_EQ(aggregator.addDocument(run(2, true, {3, 6})), 1u);
+	EXPECT_EQ(aggregator.addDocument(run(3, false, {2})), 1u);
+
+	EXPECT_EQ(aggregator.getNumRuns(), 3u);
+	EXPECT_EQ(aggregator.getNumConfigurations(), 2u);
+
+	std::vector<std::string> expected = {
+		"incremental,numPigeons,numRuns,metric,makespan,count,mean,min,max,"
+			"median,q1,q3,iqr,medianCiLow,medianCiHigh",
+		"false,5,1,learnedClauseEval.numLearnedClauses,,1,30,30,30,30,30,30,"
+			"0,30,30",
+		"false,5,1,solves.time,1,1,2,2,2,2,2,2,0,2,2",
+		"true,5,2,learnedClauseEval.numLearnedClauses,,2,15,10,20,15,12.5,"
+			"17.5,5,10,20",
+		"true,5,2,solves.time,1,2,2,1,3,2,1.5,2.5,1,1,3",
+		"true,5,2,solves.time,2,2,5,4,6,5,4.5,5.5,1,4,6"
+	};
+	EXPECT_EQ(lines(aggregator), expected);
+}
+
+TEST(ResultAggregator, mergeEqualsSingleAggregator) {
+	ResultAggregator single;
+	ResultAggregator first;
+	ResultAggregator second;
+	for (unsigned seed = 1; seed <= 6; seed++) {
+		nlohmann::json document = run(seed, seed % 2, {seed * 1.0});
+		single.addDocument(document);
+		(seed <= 3 ? first : second).addDocument(document);
+	}
+
+	ResultAggregator merged;
+	merged.merge(second);
+	merged.merge(first);
+	EXPECT_EQ(merged.getNumRuns(), 6u);
+	EXPECT_EQ(lines(merged), lines(single));
+}
+
+TEST(ResultAggregator, readsRunResults) {
+	nlohmann::json document;
+	document["runResults"] = nlohmann::json::array();
+	for (unsigned i = 0; i < 3; i++) {
+		nlohmann::json result = run(i + 1, true, {i * 1.0});
+		// the parameters keep the templates of the experiment
+		result["incphp"]["parameters"]["solver"] = "${/conf/setup/solver}";
+		result["conf"] = {
+			{"numPigeons", 5},
+			{"run", i},
+			{"setup", {{"solver", i < 2 ? "dpll" : "minisat"}}}
+		};
+		document["runResults"].push_back(result);
+	}
+	document["runResults"].push_back({{"conf", "without results"}});
+
+	ResultAggregator aggregator;
+	EXPECT_EQ(aggregator.addDocument(document), 3u);
+	EXPECT_EQ(aggregator.getNumConfigurations(), 2u);
+
+	std::vector<std::string> csv = lines(aggregator);
+	ASSERT_EQ(csv.size(), 5u);
+	EXPECT_EQ(csv[0].substr(0, 41), "numPigeons,setup.solver,numRuns,metric,ma");
+	EXPECT_EQ(csv[1].substr(0, 13), "5,dpll,2,lear");
+	EXPECT_EQ(csv[4].substr(0, 16), "5,minisat,1,solv");
+}
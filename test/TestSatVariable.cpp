@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "SatVariable.h"
+#include "VariableContainer.h"
 
 #include <set>
 
@@ -30,3 +31,97 @@ TEST( SatVariable, basic) {
         }
     }
 }
+
+TEST( SatVariable, columnMajor) {
+    SatVariableAllocator sva(SatVariableAllocator::Layout::COLUMN_MAJOR);
+    auto two = sva.newVariable(3u, 4u);
+    ASSERT_EQ(two(0u, 0u), 1);
+    ASSERT_EQ(two(1u, 0u), 2);
+    ASSERT_EQ(two(0u, 1u), 4);
+    ASSERT_EQ(two(2u, 3u), 12);
+    ASSERT_EQ(sva.numberOfVariables(), 12u);
+}
+
+TEST( SatVariable, interleaved) {
+    SatVariableAllocator sva;
+    sva.interleave({3, 3}, 2);
+    auto one = sva.newVariable(5u);
+    auto H = sva.newVariable(3u, 3u);
+    auto P = sva.newVariable(3u, 2u);
+
+    std::set<int> test;
+    for (unsigned p = 0; p < 3; p++) {
+        for (unsigned h = 0; h < 2; h++) {
+            ASSERT_EQ(P(p, h), H(p, h) + 1);
+            ASSERT_EQ(H(p, h + 1), P(p, h) + 1);
+            ASSERT_TRUE(test.insert(P(p, h)).second);
+        }
+        for (unsigned h = 0; h < 3; h++) {
+            ASSERT_TRUE(test.insert(H(p, h)).second);
+        }
+    }
+    for (unsigned i = 0; i < 5; i++) {
+        ASSERT_TRUE(test.insert(one(i)).second);
+    }
+    for (int var: test) {
+        ASSERT_GE(var, 1);
+        ASSERT_LE(var, static_cast<int>(sva.numberOfVariables()));
+    }
+}
+
+TEST( SatVariable, containerLayouts) {
+    typedef ContainerCombinator<VariableContainer3SAT, BasicVariableContainer>
+        Container;
+    unsigned n = 5;
+
+    Container holeMajor(n, VariableLayout::HOLE_MAJOR);
+    ASSERT_EQ(holeMajor.pigeonInHole(1, 2), holeMajor.pigeonInHole(0, 2) + 1);
+
+    Container interleaved(n, VariableLayout::INTERLEAVED);
+    std::set<int> test;
+    for (unsigned p = 0; p < n; p++) {
+        for (unsigned h = 0; h < n - 1; h++) {
+            ASSERT_EQ(interleaved.pigeonInHole(p, h),
+                interleaved.connector(p, h) + 1);
+            ASSERT_EQ(interleaved.connector(p, h + 1),
+                interleaved.pigeonInHole(p, h) + 1);
+            ASSERT_TRUE(test.insert(interleaved.pigeonInHole(p, h)).second);
+        }
+    }
+    ASSERT_EQ(interleaved.getAllocator().numberOfVariables(), 2 * n * n);
+}
+
+TEST( SatVariable, extendedContainerLayouts) {
+    typedef ContainerCombinator<VariableContainer3SAT, ExtendedVariableContainer>
+        Container;
+    unsigned n = 5;
+
+    Container holeMajor(n, VariableLayout::HOLE_MAJOR);
+    for (unsigned layer = 0; layer <= n; layer++) {
+        ASSERT_EQ(holeMajor.pigeonInHole(layer, 1, 2),
+            holeMajor.pigeonInHole(layer, 0, 2) + 1);
+    }
+    ASSERT_EQ(holeMajor.pigeonInHole(2, 3), holeMajor.pigeonInHole(n, 2, 3));
+
+    Container interleaved(n, VariableLayout::INTERLEAVED);
+    std::set<int> test;
+    for (unsigned p = 0; p < n; p++) {
+        for (unsigned h = 0; h < n - 1; h++) {
+            ASSERT_EQ(interleaved.pigeonInHole(p, h),
+                interleaved.connector(p, h) + 1);
+            ASSERT_EQ(interleaved.connector(p, h + 1),
+                interleaved.pigeonInHole(p, h) + 1);
+            for (unsigned layer = 0; layer <= n; layer++) {
+                ASSERT_TRUE(test.insert(
+                    interleaved.pigeonInHole(layer, p, h)).second);
+            }
+        }
+    }
+    for (unsigned p = 0; p < n; p++) {
+        for (unsigned h = 0; h < n; h++) {
+            ASSERT_TRUE(test.insert(interleaved.connector(p, h)).second);
+        }
+    }
+    ASSERT_EQ(interleaved.getAllocator().numberOfVariables(),
+        2 * n * n + n * n * (n - 1));
+}
@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+#include "SimplifyingDecorator.h"
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+	typedef std::vector<std::vector<int>> Formula;
+
+	bool satisfies(const Formula& formula, const std::vector<int>& assumptions,
+			std::function<bool(int)> isTrue) {
+		for (int lit: assumptions) {
+			if (!isTrue(lit)) {
+				return false;
+			}
+		}
+		for (const std::vector<int>& clause: formula) {
+			bool satisfied = false;
+			for (int lit: clause) {
+				satisfied |= isTrue(lit);
+			}
+			if (!satisfied) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Solves by enumerating all assignments of the first numVars variables.
+	 */
+	bool bruteForce(const Formula& formula, const std::vector<int>& assumptions,
+			unsigned numVars, std::vector<bool>* model = nullptr) {
+		for (unsigned bits = 0; bits < (1u << numVars); bits++) {
+			auto isTrue = [bits](int lit) {
+				bool value = (bits >> (std::abs(lit) - 1)) & 1;
+				return (lit > 0) ? value : !value;
+			};
+			if (satisfies(formula, assumptions, isTrue)) {
+				if (model != nullptr) {
+					model->assign(numVars + 1, false);
+					for (unsigned var = 1; var <= numVars; var++) {
+						(*model)[var] = isTrue(var);
+					}
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	class BruteForceSolver: public ipasir::Ipasir {
+	public:
+		BruteForceSolver(unsigned _numVars, Formula& _received):
+			numVars(_numVars),
+			received(_received) {
+		}
+
+		virtual std::string signature() {
+			return "brute-force";
+		}
+
+		virtual void add(int lit_or_zero) {
+			if (lit_or_zero == 0) {
+				received.push_back(clause);
+				clause.clear();
+			} else {
+				clause.push_back(lit_or_zero);
+			}
+		}
+
+		virtual void assume(int lit) {
+			assumptions.push_back(lit);
+		}
+
+		virtual ipasir::SolveResult solve() {
+			bool sat = bruteForce(received, assumptions, numVars, &model);
+			assumptions.clear();
+			return sat ? ipasir::SolveResult::SAT : ipasir::SolveResult::UNSAT;
+		}
+
+		virtual int val(int lit) {
+			return model[std::abs(lit)] ? std::abs(lit) : -std::abs(lit);
+		}
+
+		virtual int failed(int) {
+			return 1;
+		}
+
+		virtual void set_terminate(std::function<int(void)>) {
+		}
+
+		virtual void set_learn(int, std::function<void(int*)>) {
+		}
+
+		virtual void reset() {
+			received.clear();
+		}
+
+	private:
+		unsigned numVars;
+		Formula& received;
+		std::vector<int> clause;
+		std::vector<int> assumptions;
+		std::vector<bool> model;
+	};
+}
+
+TEST( SimplifyingDecorator, unitsAndSubsumption) {
+	Formula received;
+	SimplifyingDecorator solver(
+		std::make_unique<BruteForceSolver>(4, received));
+
+	solver.addClause({1});
+	solver.addClause({1, 2, 3});
+	solver.addClause({-1, 2, 3});
+	solver.addClause({3, 2});
+	solver.addClause({2, 3, 4});
+	solver.addClause({-4, -4, 4});
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::SAT);
+
+	Formula expected = {{1}, {2, 3}};
+	ASSERT_EQ(received, expected);
+
+	solver.addClause({2, 3, -4});
+	solver.addClause({-1, -2});
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::SAT);
+	// 2 v 3 v -4 is shortened before -2 is known
+	expected = {{1}, {2, 3}, {-2}, {3, -4}};
+	ASSERT_EQ(received, expected);
+	ASSERT_EQ(solver.val(3), 3);
+}
+
+TEST( SimplifyingDecorator, eliminationRestoresOnTouch) {
+	Formula received;
+	SimplifyingDecorator solver(
+		std::make_unique<BruteForceSolver>(4, received), true);
+
+	solver.addClause({1, 2});
+	solver.addClause({-2, 3});
+	solver.assume(-1);
+	solver.assume(3);
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::SAT);
+	// 2 only occurs in buffered clauses, leaving the resolvent 1 v 3
+	Formula expected = {{1, 3}};
+	ASSERT_EQ(received, expected);
+	ASSERT_EQ(solver.val(2), 2);
+	ASSERT_EQ(solver.val(3), 3);
+
+	solver.assume(-2);
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::SAT);
+	ASSERT_EQ(solver.val(1), 1);
+
+	solver.assume(-1);
+	solver.assume(-2);
+	ASSERT_EQ(solver.solve(), ipasir::SolveResult::UNSAT);
+}
+
+TEST( SimplifyingDecorator, randomIncrementalFormulas) {
+	const unsigned numVars = 8;
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> var(1, numVars);
+	std::uniform_int_distribution<int> sign(0, 1);
+	std::uniform_int_distribution<int> length(1, 4);
+
+	for (unsigned round = 0; round < 200; round++) {
+		Formula received;
+		Formula emitted;
+		SimplifyingDecorator solver(
+			std::make_unique<BruteForceSolver>(numVars, received),
+			round % 2 == 0);
+
+		for (unsigned step = 0; step < 4; step++) {
+			for (unsigned i = 0; i < 4; i++) {
+				std::vector<int> clause;
+				int size = (length(random) + length(random)) / 2;
+				for (int j = 0; j < size; j++) {
+					clause.push_back(sign(random) ? var(random) : -var(random));
+				}
+				emitted.push_back(clause);
+				solver.addClause(clause);
+			}
+
+			std::vector<int> assumptions;
+			if (sign(random)) {
+				assumptions.push_back(sign(random) ? var(random) : -var(random));
+			}
+			for (int lit: assumptions) {
+				solver.assume(lit);
+			}
+
+			bool expected = bruteForce(emitted, assumptions, numVars);
+			bool sat = (solver.solve() == ipasir::SolveResult::SAT);
+			ASSERT_EQ(sat, expected) << "round " << round;
+			if (sat) {
+				ASSERT_TRUE(satisfies(emitted, assumptions, [&solver](int lit){
+					return solver.val(lit) == lit;
+				})) << "round " << round;
+			}
+		}
+	}
+}
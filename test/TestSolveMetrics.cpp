@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "SolveMetrics.h"
+#include "PHPEncoder.h"
+#include "TestHelpers.h"
+
+#include <thread>
+#include <vector>
+
+TEST(SolveMetrics, scopeBindsToThread) {
+	SolveMetrics outer;
+	SolveMetrics inner;
+	SolveMetrics& unbound = SolveMetrics::current();
+	{
+		SolveMetrics::Scope outerScope(outer);
+		EXPECT_EQ(&SolveMetrics::current(), &outer);
+		{
+			SolveMetrics::Scope innerScope(inner);
+			EXPECT_EQ(&SolveMetrics::current(), &inner);
+
+			std::thread other([&inner]() {
+				EXPECT_NE(&SolveMetrics::current(), &inner);
+			});
+			other.join();
+		}
+		EXPECT_EQ(&SolveMetrics::current(), &outer);
+	}
+	EXPECT_EQ(&SolveMetrics::current(), &unbound);
+}
+
+TEST(SolveMetrics, solvesKeepTheirAddress) {
+	SolveMetrics metrics;
+	metrics.solves().emplace_back();
+	nlohmann::json& first = metrics.solves().front();
+	for (unsigned i = 0; i < 1000; i++) {
+		metrics.solves().emplace_back();
+	}
+	EXPECT_EQ(&first, &metrics.solves().front());
+}
+
+TEST(SolveMetrics, mergeAppendsSolvesAndSetsFields) {
+	nlohmann::json result;
+	result["solves"] = {{{"makespan", 1}}};
+	result["restarts"]["budget"] = 2;
+
+	SolveMetrics metrics;
+	metrics.solves().push_back({{"makespan", 2}});
+	metrics.result("restarts")["numRestarts"] = 3;
+	metrics.result("counting")["numSolves"] = 4;
+	metrics.mergeInto(result);
+
+	EXPECT_EQ(result["solves"].size(), 2u);
+	EXPECT_EQ(result["solves"][1]["makespan"], 2);
+	EXPECT_EQ(result["restarts"]["budget"], 2);
+	EXPECT_EQ(result["restarts"]["numRestarts"], 3);
+	EXPECT_EQ(result["counting"]["numSolves"], 4);
+	EXPECT_TRUE(metrics.solves().empty());
+}
+
+TEST(SolveMetrics, parallelEncodersRecordSeparately) {
+	initTestCarj();
+
+	const unsigned numThreads = 4;
+	const unsigned numMakespans = 200;
+	nlohmann::json result;
+
+	std::vector<std::thread> threads;
+	for (unsigned thread = 0; thread < numThreads; thread++) {
+		threads.emplace_back([&result, thread, numMakespans]() {
+			SolveMetrics metrics;
+			{
+				SolveMetrics::Scope scope(metrics);
+				for (unsigned i = 0; i < numMakespans; i++) {
+					CollectData::MakespanAndTime m(thread);
+				}
+			}
+			EXPECT_EQ(metrics.solves().size(), numMakespans);
+			metrics.mergeInto(result);
+		});
+	}
+	for (std::thread& thread: threads) {
+		thread.join();
+	}
+
+	ASSERT_EQ(result["solves"].size(), numThreads * numMakespans);
+	std::vector<unsigned> perThread(numThreads, 0);
+	for (const nlohmann::json& solve: result["solves"]) {
+		perThread[solve["makespan"].get<unsigned>()] += 1;
+		EXPECT_TRUE(solve["time"].is_number());
+	}
+	for (unsigned count: perThread) {
+		EXPECT_EQ(count, numMakespans);
+	}
+}
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "carj/Statistics.h"
+
+#include <vector>
+
+TEST( Statistics, quantile) {
+	std::vector<double> sorted = {1, 2, 3, 4};
+	ASSERT_DOUBLE_EQ(carj::quantile(sorted, 0), 1);
+	ASSERT_DOUBLE_EQ(carj::quantile(sorted, 0.5), 2.5);
+	ASSERT_DOUBLE_EQ(carj::quantile(sorted, 0.25), 1.75);
+	ASSERT_DOUBLE_EQ(carj::quantile(sorted, 1), 4);
+}
+
+TEST( Statistics, summarize) {
+	std::vector<double> samples;
+	for (unsigned i = 100; i >= 1; i--) {
+		samples.push_back(i);
+	}
+
+	carj::Summary summary = carj::summarize(samples);
+	ASSERT_EQ(summary.count, 100u);
+	ASSERT_DOUBLE_EQ(summary.mean, 50.5);
+	ASSERT_DOUBLE_EQ(summary.median, 50.5);
+	ASSERT_DOUBLE_EQ(summary.min, 1);
+	ASSERT_DOUBLE_EQ(summary.max, 100);
+	ASSERT_DOUBLE_EQ(summary.iqr, 49.5);
+
+	// ranks 40 and 61 for n = 100
+	ASSERT_DOUBLE_EQ(summary.medianCiLow, 40);
+	ASSERT_DOUBLE_EQ(summary.medianCiHigh, 61);
+}
+
+TEST( Statistics, singleSample) {
+	carj::Summary summary = carj::summarize({3});
+	ASSERT_DOUBLE_EQ(summary.median, 3);
+	ASSERT_DOUBLE_EQ(summary.iqr, 0);
+	ASSERT_DOUBLE_EQ(summary.medianCiLow, 3);
+	ASSERT_DOUBLE_EQ(summary.medianCiHigh, 3);
+}
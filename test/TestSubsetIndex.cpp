@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "SubsetIndex.h"
+
+#include <random>
+#include <vector>
+
+TEST( SubsetIndex, containsSubsetOf) {
+	SubsetIndex index;
+	ASSERT_FALSE(index.containsSubsetOf({}));
+
+	ASSERT_TRUE(index.insert({3, 1}));
+	ASSERT_TRUE(index.insert({2, 4, 5}));
+	ASSERT_EQ(index.size(), 2u);
+
+	ASSERT_TRUE(index.containsSubsetOf({1, 3}));
+	ASSERT_TRUE(index.containsSubsetOf({0, 1, 2, 3}));
+	ASSERT_TRUE(index.containsSubsetOf({5, 4, 2}));
+	ASSERT_FALSE(index.containsSubsetOf({1, 2, 4}));
+	ASSERT_FALSE(index.containsSubsetOf({3}));
+}
+
+TEST( SubsetIndex, keepsMinimalSets) {
+	SubsetIndex index;
+	ASSERT_TRUE(index.insert({1, 2, 3}));
+	ASSERT_TRUE(index.insert({1, 4, 5}));
+	ASSERT_TRUE(index.insert({2, 6}));
+	ASSERT_FALSE(index.insert({1, 2, 3, 7}));
+
+	ASSERT_TRUE(index.insert({1}));
+	ASSERT_EQ(index.size(), 2u);
+	ASSERT_TRUE(index.containsSubsetOf({2, 6}));
+	ASSERT_FALSE(index.containsSubsetOf({2, 3}));
+
+	ASSERT_TRUE(index.insert({}));
+	ASSERT_EQ(index.size(), 1u);
+	ASSERT_TRUE(index.containsSubsetOf({}));
+}
+
+TEST( SubsetIndex, randomSets) {
+	std::mt19937 random(7);
+	std::uniform_int_distribution<unsigned> bits(0, (1u << 10) - 1);
+
+	SubsetIndex index;
+	std::vector<unsigned> stored;
+	auto toSet = [](unsigned mask) {
+		std::vector<unsigned> set;
+		for (unsigned i = 0; i < 10; i++) {
+			if ((mask >> i) & 1) {
+				set.push_back(i);
+			}
+		}
+		return set;
+	};
+
+	for (unsigned round = 0; round < 500; round++) {
+		// sets of 5 or more elements
+		unsigned mask = bits(random) | bits(random);
+		if (__builtin_popcount(mask) < 5) {
+			continue;
+		}
+
+		bool expected = false;
+		for (unsigned other: stored) {
+			expected |= ((other & mask) == other);
+		}
+		ASSERT_EQ(index.containsSubsetOf(toSet(mask)), expected);
+
+		if (round % 3 == 0) {
+			index.insert(toSet(mask));
+			stored.push_back(mask);
+		}
+	}
+}
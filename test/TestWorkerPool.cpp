@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "WorkerPool.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+	nlohmann::json runJob(const nlohmann::json& job) {
+		std::string kind = job["kind"];
+		if (kind == "crash") {
+			std::abort();
+		} else if (kind == "sleep") {
+			sleep(10);
+		} else if (kind == "throw") {
+			throw std::runtime_error("thrown");
+		}
+		return job["value"];
+	}
+}
+
+TEST(WorkerPool, crashesAndTimeoutsDoNotStopOthers) {
+	std::vector<nlohmann::json> jobs = {
+		{{"kind", "crash"}},
+		{{"kind", "sleep"}},
+		{{"kind", "throw"}},
+		{{"kind", "value"}, {"value", 3}},
+		{{"kind", "value"}, {"value", 4}}
+	};
+
+	WorkerPool pool(2, runJob, 0.5);
+	std::map<int, nlohmann::json> results;
+	pool.run(jobs, [&results](const nlohmann::json& result) {
+		results[result["job"].get<int>()] = result;
+	});
+
+	ASSERT_EQ(results.size(), jobs.size());
+	EXPECT_EQ(results[0]["status"], "crashed");
+	EXPECT_EQ(results[0]["what"], std::string("signal ") + strsignal(SIGABRT));
+	EXPECT_EQ(results[1]["status"], "timeout");
+	EXPECT_LT(results[1]["time"].get<double>(), 5);
+	EXPECT_EQ(results[2]["status"], "error");
+	EXPECT_EQ(results[2]["what"], "thrown");
+	EXPECT_EQ(results[3]["status"], "ok");
+	EXPECT_EQ(results[3]["result"], 3);
+	EXPECT_EQ(results[4]["status"], "ok");
+	EXPECT_EQ(results[4]["result"], 4);
+
+	// the crashed and the timed out worker were replaced
+	for (int job: {3, 4}) {
+		EXPECT_NE(results[job]["worker"], results[0]["worker"]);
+		EXPECT_NE(results[job]["worker"], results[1]["worker"]);
+	}
+}